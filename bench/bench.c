@@ -0,0 +1,437 @@
+/*=======================================================================================
+
+TinyINI - small and simple open-source library for loading, saving and
+managing INI file data structures in the memory.
+
+TinyINI is distributed under following terms and conditions:
+
+Copyright (c) 2015-2016, Ivan Pizhenko.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ''AS IS''
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL BEN HOYT BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+SPECIAL NOTICE
+TinyINI library relies on the open-source INIH library
+(https://github.com/benhoyt/inih) for parsing text of INI file.
+Source code of INIH library and information about it, including
+licensing conditions, is included in the subfolder inih.
+
+=======================================================================================*/
+
+/* Microbenchmarks of the TinyINI library on synthetic INI files.
+ * Each benchmark prints single JSON line with its name, generator parameters,
+ * time per operation, allocations per operation and peak resident set size,
+ * so that outputs of two runs can be compared line by line.
+ */
+
+#include "tini/tini.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Memory allocation functions are replaced to count allocations, including ones made
+ * inside the C library on behalf of TinyINI, like strdup and fopen.
+ */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static unsigned long long alloc_count = 0;
+
+void* malloc(size_t size) {
+	++alloc_count;
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+	++alloc_count;
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+	++alloc_count;
+	return __libc_realloc(ptr, size);
+}
+
+/* Generator parameters */
+struct bench_config {
+	size_t section_count; /* number of sections */
+	size_t key_count; /* number of parameter lines per section */
+	size_t key_length; /* length of section and parameter names */
+	size_t value_length; /* length of parameter values */
+	double duplicate_ratio; /* fraction of parameter lines repeating earlier name in the same section */
+	size_t iterations; /* number of iterations of whole-file benchmarks */
+	size_t lookups; /* number of lookups */
+};
+
+/* Generated INI file */
+struct bench_data {
+	char* text; /* INI file text */
+	size_t length; /* text length */
+	char** sections; /* section names */
+	char** keys; /* parameter names, key_count per section, NULL for lines which repeat earlier name */
+	size_t* names; /* index of parameter name for each line */
+	char** values; /* parameter values, key_count per section */
+	char path[64]; /* temporary file with the text */
+};
+
+/* Measurement of a single benchmark */
+struct bench_result {
+	double start_time; /* start time, ns */
+	unsigned long long start_alloc_count; /* allocation count at start */
+};
+
+static unsigned long long random_state = 88172645463325252ULL;
+
+static size_t next_random(void) {
+	/* Xorshift generator, so that all runs use the same data */
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return (size_t)random_state;
+}
+
+static char* make_name(char prefix, size_t index, size_t length) {
+	/* Unique name is prefix and index in base 36, padded with random letters to the given length */
+	static const char digits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+	char buffer[32];
+	size_t n = 0, size;
+	char* name;
+	do {
+		buffer[n++] = digits[index % 36];
+		index /= 36;
+	} while (index != 0);
+	size = n + 1 > length ? n + 1 : length;
+	name = malloc(size + 1);
+	if (!name)
+		return NULL;
+	name[0] = prefix;
+	memcpy(name + 1, buffer, n);
+	for (++n; n < size; ++n)
+		name[n] = digits[10 + next_random() % 26];
+	name[size] = '\0';
+	return name;
+}
+
+static int generate(const struct bench_config* config, struct bench_data* data) {
+	size_t i, j, n = config->section_count * config->key_count, size = 0;
+	int fd;
+	FILE* f;
+	char* p;
+
+	/* Generate names and values */
+	data->sections = calloc(config->section_count + 1, sizeof(char*));
+	data->keys = calloc(n + 1, sizeof(char*));
+	data->names = calloc(n + 1, sizeof(size_t));
+	data->values = calloc(n + 1, sizeof(char*));
+	if (!data->sections || !data->keys || !data->names || !data->values)
+		return -1;
+	for (i = 0; i < config->section_count; ++i) {
+		if (!(data->sections[i] = make_name('s', i, config->key_length)))
+			return -1;
+		size += strlen(data->sections[i]) + 3;
+		for (j = 0; j < config->key_count; ++j) {
+			/* Duplicate lines repeat name of some earlier line of the same section */
+			size_t k = i * config->key_count + j;
+			if (j > 0 && (double)(next_random() % 1000000) < config->duplicate_ratio * 1000000.0) {
+				data->names[k] = data->names[i * config->key_count + next_random() % j];
+			} else {
+				data->names[k] = k;
+				if (!(data->keys[k] = make_name('k', j, config->key_length)))
+					return -1;
+			}
+			if (!(data->values[k] = make_name('v', k, config->value_length)))
+				return -1;
+			size += strlen(data->keys[data->names[k]]) + strlen(data->values[k]) + 2;
+		}
+	}
+
+	/* Build text */
+	data->text = p = malloc(size + 1);
+	if (!p)
+		return -1;
+	for (i = 0; i < config->section_count; ++i) {
+		p += sprintf(p, "[%s]\n", data->sections[i]);
+		for (j = 0; j < config->key_count; ++j) {
+			size_t k = i * config->key_count + j;
+			p += sprintf(p, "%s=%s\n", data->keys[data->names[k]], data->values[k]);
+		}
+	}
+	data->length = (size_t)(p - data->text);
+
+	/* Write text into temporary file */
+	strcpy(data->path, "/tmp/tini_bench.XXXXXX");
+	fd = mkstemp(data->path);
+	if (fd < 0)
+		return -1;
+	f = fdopen(fd, "w");
+	if (!f) {
+		close(fd);
+		return -1;
+	}
+	if (fwrite(data->text, 1, data->length, f) != data->length) {
+		fclose(f);
+		return -1;
+	}
+	return fclose(f);
+}
+
+static void free_data(const struct bench_config* config, struct bench_data* data) {
+	size_t i, n = config->section_count * config->key_count;
+	if (data->path[0])
+		unlink(data->path);
+	for (i = 0; data->sections && i < config->section_count; ++i)
+		free(data->sections[i]);
+	for (i = 0; data->keys && i < n; ++i)
+		free(data->keys[i]);
+	for (i = 0; data->values && i < n; ++i)
+		free(data->values[i]);
+	free(data->sections);
+	free(data->keys);
+	free(data->names);
+	free(data->values);
+	free(data->text);
+}
+
+static double now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static long peak_rss_kb(void) {
+	struct rusage usage;
+	return getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : -1;
+}
+
+static void start_bench(struct bench_result* result) {
+	result->start_alloc_count = alloc_count;
+	result->start_time = now();
+}
+
+static void report_bench(const struct bench_result* result, const struct bench_config* config, 
+			 const char* name, size_t op_count) {
+	/* Time is taken before printing, which allocates too */
+	double elapsed = now() - result->start_time;
+	unsigned long long allocs = alloc_count - result->start_alloc_count;
+	if (op_count == 0)
+		op_count = 1;
+	printf("{\"bench\":\"%s\",\"sections\":%lu,\"keys\":%lu,\"key_length\":%lu,\"value_length\":%lu,"
+		"\"duplicate_ratio\":%.3f,\"ops\":%lu,\"ns_per_op\":%.2f,\"allocs_per_op\":%.3f,\"peak_rss_kb\":%ld}\n",
+		name, (unsigned long)config->section_count, (unsigned long)config->key_count, 
+		(unsigned long)config->key_length, (unsigned long)config->value_length, config->duplicate_ratio, 
+		(unsigned long)op_count, elapsed / op_count, (double)allocs / op_count, peak_rss_kb());
+	fflush(stdout);
+}
+
+static int bench_load(const struct bench_config* config, const struct bench_data* data) {
+	struct bench_result result;
+	double free_time = 0;
+	size_t i;
+	start_bench(&result);
+	for (i = 0; i < config->iterations; ++i) {
+		ini_file* ini = tini_load_ini(data->path);
+		double t;
+		if (!ini)
+			return -1;
+		/* Freeing is measured by its own benchmark */
+		t = now();
+		tini_free_ini(ini);
+		free_time += now() - t;
+	}
+	result.start_time += free_time;
+	report_bench(&result, config, "load", config->iterations);
+	return 0;
+}
+
+static int bench_free(const struct bench_config* config, const struct bench_data* data) {
+	struct bench_result result;
+	double time = 0;
+	unsigned long long allocs = 0;
+	size_t i;
+	for (i = 0; i < config->iterations; ++i) {
+		ini_file* ini = tini_load_ini(data->path);
+		if (!ini)
+			return -1;
+		start_bench(&result);
+		tini_free_ini(ini);
+		time += now() - result.start_time;
+		allocs += alloc_count - result.start_alloc_count;
+	}
+	result.start_time = now() - time;
+	result.start_alloc_count = alloc_count - allocs;
+	report_bench(&result, config, "free", config->iterations);
+	return 0;
+}
+
+static int bench_add(const struct bench_config* config, const struct bench_data* data) {
+	struct bench_result result;
+	size_t i, j, k, n = config->section_count * config->key_count;
+	double free_time = 0;
+	start_bench(&result);
+	for (i = 0; i < config->iterations; ++i) {
+		ini_file* ini = tini_create_ini();
+		double t;
+		if (!ini)
+			return -1;
+		for (j = 0; j < config->section_count; ++j) {
+			for (k = j * config->key_count; k < (j + 1) * config->key_count; ++k) {
+				if (tini_add_parameter(ini, data->sections[j], data->keys[data->names[k]], data->values[k], 1) != 0) {
+					tini_free_ini(ini);
+					return -1;
+				}
+			}
+		}
+		t = now();
+		tini_free_ini(ini);
+		free_time += now() - t;
+	}
+	result.start_time += free_time;
+	report_bench(&result, config, "add", config->iterations * n);
+	return 0;
+}
+
+static int bench_find(const struct bench_config* config, const struct bench_data* data, const ini_file* ini, int hit) {
+	struct bench_result result;
+	size_t i, n = config->section_count * config->key_count, found = 0;
+	const char** sections;
+	const char** keys;
+	
+	/* Pick random lookups in advance. Misses look for absent parameter in existing section, 
+	 * or for absent section.
+	 */
+	if (n == 0)
+		return 0;
+	sections = malloc(sizeof(char*) * config->lookups);
+	keys = malloc(sizeof(char*) * config->lookups);
+	if (!sections || !keys) {
+		free(sections);
+		free(keys);
+		return -1;
+	}
+	for (i = 0; i < config->lookups; ++i) {
+		size_t k = next_random() % n;
+		sections[i] = data->sections[k / config->key_count];
+		keys[i] = data->keys[data->names[k]];
+		if (!hit) {
+			if (i % 2)
+				sections[i] = "absent section";
+			else
+				keys[i] = "absent parameter";
+		}
+	}
+	
+	start_bench(&result);
+	for (i = 0; i < config->lookups; ++i) {
+		if (tini_find_parameter(ini, sections[i], keys[i], NULL))
+			++found;
+	}
+	report_bench(&result, config, hit ? "find_hit" : "find_miss", config->lookups);
+	free(sections);
+	free(keys);
+	
+	/* All hits and no misses must be found */
+	if (found != (hit ? config->lookups : 0)) {
+		fprintf(stderr, "tini_bench: %lu of %lu lookups found\n", (unsigned long)found, (unsigned long)config->lookups);
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+static int bench_dump(const struct bench_config* config, const ini_file* ini) {
+	struct bench_result result;
+	size_t i, length;
+	start_bench(&result);
+	for (i = 0; i < config->iterations; ++i) {
+		char* text = tini_dump_to_buffer(ini, &length);
+		if (!text)
+			return -1;
+		free(text);
+	}
+	report_bench(&result, config, "dump", config->iterations);
+	return 0;
+}
+
+static void usage(void) {
+	fprintf(stderr, 
+		"Usage: tini_bench [options]\n"
+		"  -s N   number of sections (default 1000)\n"
+		"  -k N   number of parameter lines per section (default 20)\n"
+		"  -n N   length of section and parameter names (default 12)\n"
+		"  -v N   length of parameter values (default 24)\n"
+		"  -d R   fraction of parameter lines repeating earlier name, 0..1 (default 0)\n"
+		"  -i N   iterations of load, add, dump and free benchmarks (default 20)\n"
+		"  -l N   number of lookups (default 1000000)\n");
+}
+
+int main(int argc, char** argv) {
+	struct bench_config config;
+	struct bench_data data;
+	ini_file* ini = NULL;
+	int opt, res = 1;
+	
+	config.section_count = 1000;
+	config.key_count = 20;
+	config.key_length = 12;
+	config.value_length = 24;
+	config.duplicate_ratio = 0;
+	config.iterations = 20;
+	config.lookups = 1000000;
+	while ((opt = getopt(argc, argv, "s:k:n:v:d:i:l:h")) != -1) {
+		switch (opt) {
+		case 's': config.section_count = strtoul(optarg, NULL, 10); break;
+		case 'k': config.key_count = strtoul(optarg, NULL, 10); break;
+		case 'n': config.key_length = strtoul(optarg, NULL, 10); break;
+		case 'v': config.value_length = strtoul(optarg, NULL, 10); break;
+		case 'd': config.duplicate_ratio = strtod(optarg, NULL); break;
+		case 'i': config.iterations = strtoul(optarg, NULL, 10); break;
+		case 'l': config.lookups = strtoul(optarg, NULL, 10); break;
+		default: usage(); return opt == 'h' ? 0 : 1;
+		}
+	}
+	
+	memset(&data, 0, sizeof(data));
+	if (generate(&config, &data) != 0)
+		goto done;
+	if (bench_load(&config, &data) != 0 || bench_add(&config, &data) != 0)
+		goto done;
+	ini = tini_load_ini(data.path);
+	if (!ini)
+		goto done;
+	if (bench_find(&config, &data, ini, 1) != 0 || bench_find(&config, &data, ini, 0) != 0 
+	    || bench_dump(&config, ini) != 0 || bench_free(&config, &data) != 0)
+		goto done;
+	res = 0;
+	
+done:
+	if (res != 0)
+		perror("tini_bench");
+	tini_free_ini(ini);
+	free_data(&config, &data);
+	return res;
+}
@@ -45,26 +45,101 @@ licensing conditions, is included in the subfolder inih.
 
 #include <stddef.h>
 
+#if defined(TINI_FEATURE_SAVE_INI) || defined(TINI_FEATURE_DUMP_INI)
+#include <stdio.h>
+#endif
+
+#ifdef TINI_FEATURE_TYPED_VALUES
+#include <stdint.h>
+#endif
+
+/* Binary cache files are frozen INI file snapshots */
+#if defined(TINI_FEATURE_BINARY_CACHE) && !defined(TINI_FEATURE_FREEZE_INI)
+#define TINI_FEATURE_FREEZE_INI
+#endif
+
+/* Directory loader loads files in parallel */
+#if defined(TINI_FEATURE_LOAD_DIR) && !defined(TINI_FEATURE_PARALLEL_LOAD)
+#define TINI_FEATURE_PARALLEL_LOAD
+#endif
+
+/* INI file watchers reload reloadable INI file handles */
+#if defined(TINI_FEATURE_WATCH_INI) && !defined(TINI_FEATURE_RELOAD_INI)
+#define TINI_FEATURE_RELOAD_INI
+#endif
+
 /* Initial size of the storage for section objects */
 #ifndef TINI_SECTION_STORAGE_INITIAL_SIZE
 #define TINI_SECTION_STORAGE_INITIAL_SIZE 4
 #endif
 
-/* Automatic size increment of the storage for section objects */
+/* Minimum automatic size increment of the storage for section objects, storage grows geometrically */
 #ifndef TINI_SECTION_STORAGE_SIZE_INCREMENT
 #define TINI_SECTION_STORAGE_SIZE_INCREMENT 4
 #endif
 
-/* Initial size of the storage for parameter objects in the each section */
+/* Initial number of slots in the section name hash table, must be power of two */
+#ifndef TINI_SECTION_INDEX_INITIAL_SIZE
+#define TINI_SECTION_INDEX_INITIAL_SIZE 8
+#endif
+
+/* Number of parameters stored inline in the section object, before section gets separate storage */
+#ifndef TINI_PARAMETER_INLINE_SIZE
+#define TINI_PARAMETER_INLINE_SIZE 4
+#endif
+
+/* Initial size of the separate storage for parameter objects in the each section */
 #ifndef TINI_PARAMETER_STORAGE_INITIAL_SIZE
 #define TINI_PARAMETER_STORAGE_INITIAL_SIZE 8
 #endif
 
-/* Automatic size increment of the storage for parameter objects in the each section */
+/* Minimum automatic size increment of the storage for parameter objects in the each section, storage grows geometrically */
 #ifndef TINI_PARAMETER_STORAGE_SIZE_INCREMENT
 #define TINI_PARAMETER_STORAGE_SIZE_INCREMENT 8
 #endif
 
+/* Number of parameters at which section starts using hash table for parameter lookup, must be power of two */
+#ifndef TINI_PARAMETER_INDEX_THRESHOLD
+#define TINI_PARAMETER_INDEX_THRESHOLD 16
+#endif
+
+/* Minimum automatic size increment of the storage for multi-line parameter value, 
+ * storage grows geometrically as continuation lines are appended
+ */
+#ifndef TINI_MULTILINE_VALUE_SIZE_INCREMENT
+#define TINI_MULTILINE_VALUE_SIZE_INCREMENT 64
+#endif
+
+/* Expected average size of INI file section text in bytes, used to pre-size storage for section objects 
+ * when loading INI file of the known size.
+ */
+#ifndef TINI_LOAD_HINT_BYTES_PER_SECTION
+#define TINI_LOAD_HINT_BYTES_PER_SECTION 256
+#endif
+
+/* Maximum number of sections pre-sized by file size, so that large files of few sections don't 
+ * get huge storage, storage grows as usual beyond it
+ */
+#ifndef TINI_LOAD_HINT_MAX_SECTIONS
+#define TINI_LOAD_HINT_MAX_SECTIONS 4096
+#endif
+
+/* Size of the memory arena chunk used by INI file objects created with TINI_FLAG_USE_ARENA */
+#ifndef TINI_ARENA_CHUNK_SIZE
+#define TINI_ARENA_CHUNK_SIZE 65536
+#endif
+
+/* Parallel loader doesn't split INI files into chunks smaller than this */
+#ifndef TINI_PARALLEL_LOAD_MIN_CHUNK_SIZE
+#define TINI_PARALLEL_LOAD_MIN_CHUNK_SIZE 262144
+#endif
+
+/* INI file object flag: allocate section objects and all strings from the memory arena 
+ * owned by INI file object. Memory of removed and replaced items is reclaimed only when 
+ * INI file object is destroyed.
+ */
+#define TINI_FLAG_USE_ARENA 0x0001
+
 #ifdef __cplusplus
 extern "C" {
 #endif // __cplusplus
@@ -80,20 +155,121 @@ typedef struct _ini_file ini_file;
 /* Create empty INI file objects */
 ini_file* tini_create_ini(void);
 
+/* Create empty INI file object with given combination of TINI_FLAG_XXX flags */
+ini_file* tini_create_ini_ex(unsigned int flags);
+
 /* Destroy INI file object */
 void tini_free_ini(ini_file* ini);
 
 /* Parse given INI file into new INI file object */
 ini_file* tini_load_ini(const char* file_path);
 
+/* Parse given INI file into new INI file object created with given combination of TINI_FLAG_XXX flags */
+ini_file* tini_load_ini_ex(const char* file_path, unsigned int flags);
+
+#ifdef TINI_FEATURE_ALLOCATOR
+/* Memory allocator. Functions behave like malloc, realloc and free, and receive given context. 
+ * When INI_USE_STACK is zero, INIH library must be compiled with INI_CUSTOM_ALLOCATOR=1, 
+ * so that its line buffer is allocated by the allocator too.
+ */
+typedef struct _ini_allocator {
+	void* (*allocate)(void* context, size_t size); /* allocate memory block */
+	void* (*reallocate)(void* context, void* ptr, size_t size); /* resize memory block */
+	void (*deallocate)(void* context, void* ptr); /* free memory block, never called with NULL */
+	void* context; /* user context */
+} ini_allocator;
+
+/* Set global allocator, which is copied by new INI file objects and used for all other memory 
+ * allocated by the library: standalone sections, snapshots, handles and such. NULL restores malloc. 
+ * Must be set before the library allocates anything, or after everything is freed. 
+ * Returns zero on success, nonzero on failure. Check errno for error details.
+ */
+int tini_set_allocator(const ini_allocator* allocator);
+
+/* Same as tini_create_ini_ex, but INI file object uses given allocator, or global one if it is NULL */
+ini_file* tini_create_ini_with_allocator(unsigned int flags, const ini_allocator* allocator);
+
+/* Same as tini_load_ini_ex, but INI file object uses given allocator, or global one if it is NULL */
+ini_file* tini_load_ini_with_allocator(const char* file_path, unsigned int flags, const ini_allocator* allocator);
+#endif
+
+/* Parse INI file text of given length in bytes from memory into new INI file object. 
+ * Text is copied once and then parsed in place, it doesn't need to be null-terminated. 
+ * Object uses memory arena.
+ */
+ini_file* tini_load_ini_from_buffer(const char* data, size_t length);
+
+/* Same as tini_load_ini_from_buffer, but parses given text in place without copying it. 
+ * Takes ownership of given buffer, which must be allocated with malloc, or with the global 
+ * allocator if TINI_FEATURE_ALLOCATOR is used: it is modified, 
+ * may be reallocated to make room for terminating null, and is freed by tini_free_ini, 
+ * or right away on failure. Strings of the resulting object point into the buffer.
+ */
+ini_file* tini_load_ini_from_buffer_in_place(char* data, size_t length);
+
+#ifdef TINI_FEATURE_LOAD_INI_MMAP
+/* Parse given INI file into new INI file object without copying its text. File is mapped 
+ * into memory and parsed in place, so strings of the resulting object point into private 
+ * copy-on-write mapping of the file, which lives until tini_free_ini. Object uses memory arena. 
+ * File must not be truncated or modified in place while object exists.
+ */
+ini_file* tini_load_ini_mmap(const char* file_path);
+#endif
+
+#ifdef TINI_FEATURE_PARALLEL_LOAD
+/* Same as tini_load_ini_from_buffer, but reads given INI file, splits it into chunks at section 
+ * header lines which start in the first column, and parses copies of chunks in place using given 
+ * number of threads, or one per CPU if zero. Result is the same as if file was parsed by single thread. 
+ * Application must be linked with pthread library. 
+ * Returns NULL on failure. Check errno for error details.
+ */
+ini_file* tini_load_ini_parallel(const char* file_path, unsigned int thread_count);
+#endif
+
+#ifdef TINI_FEATURE_LOAD_DIR
+/* Result of loading single file by directory loader */
+typedef struct _ini_file_status {
+	char* file_name; /* file name */
+	int error; /* errno if file couldn't be loaded, otherwise zero */
+	int line; /* number of the first line with parse error, or zero */
+} ini_file_status;
+
+/* Load regular files from given directory whose names match given shell wildcard pattern, 
+ * or all files if it is NULL, into new INI file object. Files are parsed in parallel by 
+ * given number of threads, or one per CPU if zero, and merged in the lexical order of 
+ * their names: sections keep the first-seen order, and later parameters replace earlier 
+ * ones with the same name. Files which can't be read are skipped, while files with parse errors 
+ * are merged as far as they could be parsed, like by tini_load_ini. If statuses is not NULL, 
+ * it receives array of results for each matching file, in the same order, which must be 
+ * freed with tini_free_file_statuses. Object uses memory arena. 
+ * Returns NULL on failure. Check errno for error details.
+ */
+ini_file* tini_load_dir(const char* dir_path, const char* pattern, unsigned int thread_count, 
+			ini_file_status** statuses, size_t* status_count);
+
+/* Free array of file loading results */
+void tini_free_file_statuses(ini_file_status* statuses, size_t count);
+#endif
+
 #ifdef TINI_FEATURE_SAVE_INI
-/* Create INI file from the given INI file object */
+/* Create INI file from the given INI file object. Text is written into temporary file 
+ * next to the given one, which is flushed to disk and then renamed over it, so that 
+ * readers see either old or new file completely. 
+ * Returns zero on success, nonzero on failure. Check errno for error details.
+ */
 int tini_save_ini(const ini_file* ini, const char* file_path);
 #endif
 
 #if defined(TINI_FEATURE_SAVE_INI) || defined(TINI_FEATURE_DUMP_INI)
 /* Dump content of the given INI file object into given file descriptor. */
 int tini_dump_ini(const ini_file* ini, FILE* f);
+
+/* Dump content of the given INI file object into new null-terminated buffer, which must 
+ * be freed with free, or with the allocator of INI file object if TINI_FEATURE_ALLOCATOR is used. 
+ * If length is not NULL, it receives text length without terminating null. 
+ * Returns NULL on failure. Check errno for error details.
+ */
+char* tini_dump_to_buffer(const ini_file* ini, size_t* length);
 #endif
 
 /* Initialize INI file object */
@@ -113,21 +289,40 @@ void tini_free_section(ini_section* section);
  */
 int tini_add_parameter(ini_file* ini, const char* section, const char* key, const char* value, int replace);
 
+/* Reserve storage for at least given total number of sections in INI file object. 
+ * Returns zero on success, nonzero on failure. Check errno for error details.
+ */
+int tini_reserve_sections(ini_file* ini, size_t count);
+
+/* Reserve storage for at least given total number of parameters in INI file section object. 
+ * Returns zero on success, nonzero on failure. Check errno for error details.
+ */
+int tini_reserve_parameters(ini_section* section, size_t count);
+
 /* Add given parameter to INI file section object. If parameter exists, it may be replaced if replace is nonzero. 
  * Returns zero on success, nonzero on failure. Check errno for error details.
  */
 int tini_add_parameter_to_section(ini_section* section, const char* key, const char* value, int replace);
 
-#ifdef TINI_FEATURE_EDIT_INI_FILE
-/* Remove given parameter from INI file section object.
+#ifdef TINI_FEATURE_EDIT_INI
+/* Remove given section from INI file object. Removal takes constant time: the section leaves 
+ * a tombstone, which is dropped when storage is compacted, see tini_compact(). 
  * Returns zero on success, nonzero on failure. Check errno for error details.
  */
 int tini_remove_section(ini_file* ini, const char* section);
 
-/* Removes given section from INI file object.
+/* Remove given parameter from INI file section object. Removal takes constant time: the parameter 
+ * leaves a tombstone, which is dropped when storage is compacted, see tini_compact(). 
  * Returns zero on success, nonzero on failure. Check errno for error details.
  */
 int tini_remove_parameter(ini_file* ini, const char* section, const char* key);
+
+/* Drop tombstones of removed sections and parameters, keeping order of the remaining ones. 
+ * Storage is also compacted automatically once it is mostly tombstones, when adding to full storage, 
+ * and on reload. Functions which read the object skip tombstones and never compact it. 
+ * Compaction invalidates parameter handles.
+ */
+void tini_compact(ini_file* ini);
 #endif
 
 /* Find given section by name. Returns section handle if section found, or NULL otherwise. */
@@ -139,6 +334,34 @@ const char* tini_find_parameter_in_section(const ini_section* section, const cha
 /* Find given parameter by section name and parameter name. Returns parameter value if parameter found, or NULL otherwise. */
 const char* tini_find_parameter(const ini_file* ini, const char* section, const char* key, const char* default_value);
 
+#ifdef TINI_FEATURE_STATS
+/* Statistics counters of INI file object. Lookups include ones made while adding parameters. 
+ * Average probe length is number of probes divided by number of hits and misses.
+ */
+typedef struct _ini_stats {
+	unsigned long long allocations; /* number of memory allocations and reallocations */
+	unsigned long long allocated_bytes; /* total size of allocated memory blocks */
+	unsigned long long grow_events; /* number of times storage or hash table was grown */
+	unsigned long long section_hits; /* number of successful section lookups */
+	unsigned long long section_misses; /* number of failed section lookups */
+	unsigned long long section_probes; /* number of hash table slots checked by section lookups */
+	unsigned long long parameter_hits; /* number of successful parameter lookups */
+	unsigned long long parameter_misses; /* number of failed parameter lookups */
+	unsigned long long parameter_probes; /* number of hash table slots or names checked by parameter lookups */
+	unsigned long long parse_ns; /* time spent parsing INI file text, including adding parameters, in nanoseconds */
+	unsigned long long insert_ns; /* time spent adding parameters to sections, in nanoseconds */
+	unsigned long long free_ns; /* time spent destroying INI file objects, in nanoseconds, only counted globally */
+} ini_stats;
+
+/* Get snapshot of statistics counters of the given INI file object, or, if it is NULL, 
+ * totals of all INI file objects and standalone sections since program start or last reset.
+ */
+void tini_get_stats(const ini_file* ini, ini_stats* stats);
+
+/* Reset statistics counters of the given INI file object, or global ones if it is NULL */
+void tini_reset_stats(ini_file* ini);
+#endif
+
 #ifdef TINI_FEATURE_GET_ELEMENT_COUNT
 /* Returns count of sections in the given INI file object */
 size_t tini_get_section_count(const ini_file* ini);
@@ -148,18 +371,268 @@ size_t tini_get_parameter_count(const ini_section* section);
 #endif
 
 #ifdef TINI_FEATURE_GET_PARAMETERS_STORAGE
-/* Returns array of parameter names in the given section */
+/* Returns array of parameter names in the given section, terminated by NULL. 
+ * With TINI_FEATURE_EDIT_INI, the first call after removal makes dense copy of the storage, 
+ * and returns NULL if it can't be allocated.
+ */
 const char* const* tini_get_keys(const ini_section* section);
 
-/* Returns array of parameter values in the given section */
+/* Returns array of parameter values in the given section, terminated by NULL. 
+ * With TINI_FEATURE_EDIT_INI, the first call after removal makes dense copy of the storage, 
+ * and returns NULL if it can't be allocated.
+ */
 const char* const* tini_get_values(const ini_section* section);
 #endif
 
 #ifdef TINI_FEATURE_GET_SECTIONS_STORAGE
-/* Returns array of section objects in the given INI file object */
+/* Returns array of section objects in the given INI file object. 
+ * With TINI_FEATURE_EDIT_INI, the first call after removal makes dense copy of the storage, 
+ * and returns NULL if it can't be allocated.
+ */
 const ini_section* const* tini_get_sections(const ini_file* ini);
 #endif
 
+#ifdef TINI_FEATURE_PARAMETER_HANDLES
+/* Resolved location of a parameter in an INI file object. Fields are private. 
+ * Handle stays valid while parameters are added or replaced, and becomes stale 
+ * when any section or parameter is removed, or the object is reloaded.
+ */
+typedef struct _ini_parameter_handle {
+	const ini_section* section;
+	size_t index;
+	unsigned long long generation;
+} ini_parameter_handle;
+
+/* Resolve parameter by section name and parameter name into a handle. 
+ * Returns zero on success, nonzero on failure. Check errno for error details.
+ */
+int tini_resolve(const ini_file* ini, const char* section, const char* key, ini_parameter_handle* handle);
+
+/* Returns value of the parameter given by handle resolved in the same INI file object, 
+ * or NULL if handle is stale and parameter has to be resolved again.
+ */
+const char* tini_value_by_handle(const ini_file* ini, const ini_parameter_handle* handle);
+#endif
+
+#ifdef TINI_FEATURE_TYPED_VALUES
+/* Typed accessors convert parameter value on the first call and cache the result alongside it, 
+ * until the value is replaced. Conversions don't depend on the current locale. 
+ * Return zero on success. On failure, return nonzero and leave the result unchanged, so that it 
+ * can be preset to a default value; errno is ESRCH if section or parameter is not found, 
+ * EINVAL if value has invalid syntax, ERANGE if it is out of range.
+ */
+
+/* Get parameter value as decimal or 0x-prefixed hexadecimal integer with optional sign */
+int tini_get_int64_in_section(const ini_section* section, const char* key, int64_t* value);
+int tini_get_int64(const ini_file* ini, const char* section, const char* key, int64_t* value);
+
+/* Get parameter value as floating point number in decimal notation, inf or nan */
+int tini_get_double_in_section(const ini_section* section, const char* key, double* value);
+int tini_get_double(const ini_file* ini, const char* section, const char* key, double* value);
+
+/* Get parameter value as boolean: 1, true, yes, on or 0, false, no, off in any case */
+int tini_get_bool_in_section(const ini_section* section, const char* key, int* value);
+int tini_get_bool(const ini_file* ini, const char* section, const char* key, int* value);
+
+/* Get parameter value as duration in nanoseconds, written as sequence of numbers with units 
+ * ns, us, ms, s, m, h, d, like "1h30m" or "2.5s". Single number without unit means seconds.
+ */
+int tini_get_duration_in_section(const ini_section* section, const char* key, int64_t* nanoseconds);
+int tini_get_duration(const ini_file* ini, const char* section, const char* key, int64_t* nanoseconds);
+#endif
+
+#ifdef TINI_FEATURE_OVERLAY
+/* User-visible INI file overlay handle */
+struct _ini_overlay;
+typedef struct _ini_overlay ini_overlay;
+
+/* Create empty overlay, which stacks INI file objects as layers without copying them, 
+ * so that many overlays can share the same layers. If cache size is not zero, overlay 
+ * keeps cache of given number of recently found parameters. 
+ * Returns NULL on failure. Check errno for error details.
+ */
+ini_overlay* tini_create_overlay(size_t cache_size);
+
+/* Destroy overlay. Layers are not destroyed. */
+void tini_free_overlay(ini_overlay* overlay);
+
+/* Put given INI file object on top of the overlay, so that its parameters hide parameters 
+ * of lower layers with the same names. Layer must outlive the overlay, and must not be 
+ * modified while in it, unless tini_clear_overlay_cache is called after modification. 
+ * Returns zero on success, nonzero on failure. Check errno for error details.
+ */
+int tini_push_layer(ini_overlay* overlay, const ini_file* layer);
+
+/* Forget cached parameters of the overlay */
+void tini_clear_overlay_cache(ini_overlay* overlay);
+
+/* Check whether any layer of the overlay has given section. Returns nonzero if section found, or zero otherwise. */
+int tini_overlay_has_section(const ini_overlay* overlay, const char* section);
+
+/* Find given parameter by section name and parameter name in layers of the overlay, from top to bottom. 
+ * Returns parameter value if parameter found, or default value otherwise. Overlay with cache must not 
+ * be used by multiple threads at once, overlay without cache can.
+ */
+const char* tini_overlay_find_parameter(ini_overlay* overlay, const char* section, const char* key, const char* default_value);
+
+/* Returns count of layers in the given overlay */
+size_t tini_get_layer_count(const ini_overlay* overlay);
+#endif
+
+#ifdef TINI_FEATURE_FREEZE_INI
+/* User-visible frozen INI file snapshot handle */
+struct _ini_frozen;
+typedef struct _ini_frozen ini_frozen;
+
+/* Create read-only snapshot of the given INI file object. Snapshot is a single block of memory 
+ * with all names and values packed together, which uses minimal perfect hashing, so that lookup 
+ * takes one hash calculation and one comparison. Returns NULL on failure. Check errno for error details.
+ */
+ini_frozen* tini_freeze(const ini_file* ini);
+
+/* Destroy INI file snapshot */
+void tini_free_frozen(ini_frozen* frozen);
+
+/* Check whether INI file snapshot has given section. Returns nonzero if section found, or zero otherwise. */
+int tini_frozen_has_section(const ini_frozen* frozen, const char* section);
+
+/* Find given parameter by section name and parameter name in INI file snapshot. 
+ * Returns parameter value if parameter found, or default value otherwise.
+ */
+const char* tini_frozen_find_parameter(const ini_frozen* frozen, const char* section, const char* key, const char* default_value);
+
+/* Returns count of sections in the given INI file snapshot */
+size_t tini_frozen_get_section_count(const ini_frozen* frozen);
+
+/* Returns count of parameters in the given INI file snapshot */
+size_t tini_frozen_get_parameter_count(const ini_frozen* frozen);
+
+/* Create new INI file object with all sections and parameters of the given INI file snapshot.
+ * Returns NULL on failure. Check errno for error details.
+ */
+ini_file* tini_thaw(const ini_frozen* frozen);
+#endif
+
+#ifdef TINI_FEATURE_BINARY_CACHE
+/* Save snapshot of the given INI file object into binary cache file, replacing it atomically. 
+ * If source path is not NULL, size and modification time of that INI file are stored as well.
+ * Binary cache files are only valid on the machines with the same byte order.
+ * Returns zero on success, nonzero on failure. Check errno for error details.
+ */
+int tini_save_binary(const ini_file* ini, const char* binary_path, const char* source_path);
+
+/* Map binary cache file into memory as read-only INI file snapshot. If source path is not NULL, 
+ * fails with ESTALE when size or modification time of that INI file differ from the stored ones. 
+ * Only header of the binary cache file is validated, so it must come from a trusted location.
+ * Returns NULL on failure. Check errno for error details.
+ */
+ini_frozen* tini_load_binary(const char* binary_path, const char* source_path);
+
+/* Load snapshot of the given INI file from binary cache file if it is up to date. Otherwise parse 
+ * INI file and rebuild binary cache file. Returns NULL on failure. Check errno for error details.
+ */
+ini_frozen* tini_load_cached(const char* source_path, const char* binary_path);
+#endif
+
+#ifdef TINI_FEATURE_RELOAD_INI
+/* Reloadable INI file handle. Publishes immutable INI file object versions to concurrent 
+ * readers, which never block. Replaced versions are freed once no reader uses them.
+ */
+struct _ini_handle;
+typedef struct _ini_handle ini_handle;
+
+/* Reader of the reloadable INI file handle, owned by a single thread at a time */
+struct _ini_handle_reader;
+typedef struct _ini_handle_reader ini_handle_reader;
+
+/* Parse given INI file into new reloadable INI file handle. 
+ * Returns NULL on failure. Check errno for error details.
+ */
+ini_handle* tini_create_handle(const char* file_path);
+
+/* Destroy reloadable INI file handle along with its readers. Must not be used concurrently. */
+void tini_free_handle(ini_handle* handle);
+
+/* Make given INI file object the current version of the handle, taking ownership of it. 
+ * Waits until readers release the replaced version, then frees it. Must not be called 
+ * by a thread holding a version of the same handle.
+ */
+void tini_publish_ini(ini_handle* handle, ini_file* ini);
+
+/* Parse given INI file, or the one handle was created with if path is NULL, and publish it. 
+ * Current version is kept on failure. Returns zero on success, nonzero on failure. 
+ * Check errno for error details.
+ */
+int tini_reload(ini_handle* handle, const char* file_path);
+
+/* Register new reader of the reloadable INI file handle. 
+ * Returns NULL on failure. Check errno for error details.
+ */
+ini_handle_reader* tini_register_reader(ini_handle* handle);
+
+/* Unregister reader, releasing version it holds */
+void tini_unregister_reader(ini_handle_reader* reader);
+
+/* Returns current version of the INI file object, which stays valid until released. 
+ * Reader holds at most one version, acquiring again releases the previous one.
+ */
+const ini_file* tini_acquire_ini(ini_handle_reader* reader);
+
+/* Release version held by the reader */
+void tini_release_ini(ini_handle_reader* reader);
+#endif
+
+#ifdef TINI_FEATURE_WATCH_INI
+/* INI file watcher. Uses inotify to detect changes of the INI file of a reloadable handle, 
+ * including replacement by rename, and reloads the handle.
+ */
+struct _ini_watcher;
+typedef struct _ini_watcher ini_watcher;
+
+/* Callback called for each changed parameter on reload, after the new version is published. 
+ * Old value is NULL for added parameters, new value is NULL for removed ones.
+ */
+typedef void (*ini_change_handler)(void* user, const char* section, const char* key, 
+	const char* old_value, const char* new_value);
+
+/* Create watcher of the INI file of the given handle. Changes are applied only after 
+ * the file stays untouched for given number of milliseconds, so that writing it 
+ * in several steps causes single reload. Returns NULL on failure. Check errno for error details.
+ */
+ini_watcher* tini_create_watcher(ini_handle* handle, unsigned int debounce_ms);
+
+/* Destroy INI file watcher. Handle is not destroyed. */
+void tini_free_watcher(ini_watcher* watcher);
+
+/* Register change callback. Returns zero on success, nonzero on failure. */
+int tini_add_change_callback(ini_watcher* watcher, ini_change_handler handler, void* user);
+
+/* Returns file descriptor which becomes readable when INI file may have changed, 
+ * for use with poll or other event loops.
+ */
+int tini_get_watcher_fd(const ini_watcher* watcher);
+
+/* Wait up to given number of milliseconds, or forever if negative, for the INI file change. 
+ * If it changes, reloads the handle and calls change callbacks. Returns 1 if handle was reloaded, 
+ * zero on timeout, negative value on failure, when current version is kept. 
+ * Check errno for error details.
+ */
+int tini_process_watch_events(ini_watcher* watcher, int timeout_ms);
+#endif
+
+#ifdef TINI_FEATURE_INCREMENTAL_RELOAD
+/* Update INI file object to match given INI file, parsing only text that changed since the previous 
+ * reload. Text is split into spans at section header lines which start in the first column, and 
+ * sections whose spans are unchanged and which weren't modified since are kept as they are. 
+ * Text of the last reloaded file is kept by INI file object to compare spans with. 
+ * To load INI file for later incremental reloads, reload an empty INI file object. Text is parsed 
+ * the same way tini_load_ini_from_buffer does. Not supported for INI file objects parsed in place.
+ * Object is not changed on failure. Returns zero on success, nonzero on failure. 
+ * Check errno for error details.
+ */
+int tini_reload_ini(ini_file* ini, const char* file_path);
+#endif
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif /* __cplusplus */
@@ -18,9 +18,36 @@ https://github.com/benhoyt/inih
 #include "ini.h"
 
 #if !INI_USE_STACK
+#if INI_CUSTOM_ALLOCATOR
+#include <stddef.h>
+void* ini_malloc(size_t size);
+void ini_free(void* ptr);
+void* ini_realloc(void* ptr, size_t size);
+#else
 #include <stdlib.h>
+#define ini_malloc malloc
+#define ini_free free
+#define ini_realloc realloc
+#endif
+#endif
+
+#if INI_ALLOW_REALLOC
+#if INI_USE_STACK
+#error "INI_ALLOW_REALLOC requires INI_USE_STACK to be 0"
+#endif
+#include <limits.h>
 #endif
 
+/* Vectorized line scanning is available with GCC-compatible compilers on x86 */
+#if INI_USE_SIMD && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define INI_HAVE_SIMD 1
+#include <immintrin.h>
+#else
+#define INI_HAVE_SIMD 0
+#endif
+
+/* Maximum length of section name and name, or initial size of their buffers
+   if INI_ALLOW_REALLOC is nonzero */
 #define MAX_SECTION 50
 #define MAX_NAME 50
 
@@ -61,12 +88,370 @@ static char* find_chars_or_comment(const char* s, const char* chars)
     return (char*)s;
 }
 
-/* Version of strncpy that ensures dest (size bytes) is null-terminated. */
-static char* strncpy0(char* dest, const char* src, size_t size)
+#if INI_HAVE_SIMD
+
+/* Vectorized scanners load whole aligned blocks, which may extend past the
+   terminating null, but never cross a page boundary. */
+#if defined(__SANITIZE_ADDRESS__)
+#define INI_SIMD_FUNCTION(isa) \
+    __attribute__((target(isa), no_sanitize_address))
+#else
+#define INI_SIMD_FUNCTION(isa) __attribute__((target(isa)))
+#endif
+
+/* Maximum number of distinct bytes searched by vectorized scanners */
+#define MAX_NEEDLES 8
+
+/* Collect bytes which stop find_chars_or_comment() scan: null, chars and
+   inline comment prefixes. Return their count, or zero if there are too
+   many of them. */
+static int collect_needles(char* needles, const char* chars)
+{
+    const char* sets[2];
+    int count = 1;
+    int i;
+
+    sets[0] = chars ? chars : "";
+#if INI_ALLOW_INLINE_COMMENTS
+    sets[1] = INI_INLINE_COMMENT_PREFIXES;
+#else
+    sets[1] = "";
+#endif
+    needles[0] = '\0';
+    for (i = 0; i < 2; i++) {
+        const char* c;
+        for (c = sets[i]; *c; c++) {
+            if (count == MAX_NEEDLES)
+                return 0;
+            needles[count++] = *c;
+        }
+    }
+    return count;
+}
+
+/* Check whether candidate found by vectorized find_chars_or_comment() ends
+   the scan. Candidates are null, chars and inline comment prefixes, and the
+   latter count only after whitespace, exactly as in the scalar version. */
+static int is_chars_or_comment(const char* s, const char* q, const char* chars)
+{
+#if INI_ALLOW_INLINE_COMMENTS
+    return !*q || (chars && strchr(chars, *q)) ||
+           (q > s && isspace((unsigned char)q[-1]));
+#else
+    (void)s;
+    (void)chars;
+    (void)q;
+    return 1;
+#endif
+}
+
+/* Bitmask of bytes in 16-byte block which are not ASCII whitespace. Bytes
+   with high bit set are included, caller checks them with isspace(), so
+   that locale-specific whitespace is handled exactly as in scalar code. */
+INI_SIMD_FUNCTION("sse2")
+static unsigned int nonspace_mask_sse2(const char* p)
+{
+    __m128i b = _mm_load_si128((const __m128i*)p);
+    __m128i t = _mm_sub_epi8(b, _mm_set1_epi8(9));
+    __m128i space = _mm_or_si128(_mm_cmpeq_epi8(b, _mm_set1_epi8(' ')),
+        _mm_cmpeq_epi8(_mm_min_epu8(t, _mm_set1_epi8(4)), t));
+    return ~(unsigned int)_mm_movemask_epi8(space) & 0xFFFFu;
+}
+
+/* SSE2 version of lskip(), scans 16 bytes at a time. */
+INI_SIMD_FUNCTION("sse2")
+static char* lskip_sse2(const char* s)
+{
+    const char* p = (const char*)((size_t)s & ~(size_t)15);
+    unsigned int mask = nonspace_mask_sse2(p) & (~0u << (s - p));
+    const char* q;
+
+    for (;;) {
+        while (!mask) {
+            p += 16;
+            mask = nonspace_mask_sse2(p);
+        }
+        q = p + __builtin_ctz(mask);
+        if (!*q || !isspace((unsigned char)*q))
+            return (char*)q;
+        mask &= mask - 1;
+    }
+}
+
+/* SSE2 version of find_chars_or_comment(), scans 16 bytes at a time. */
+INI_SIMD_FUNCTION("sse2")
+static char* find_chars_or_comment_sse2(const char* s, const char* chars)
+{
+    char bytes[MAX_NEEDLES];
+    __m128i needles[MAX_NEEDLES];
+    int count = collect_needles(bytes, chars);
+    const char* p = (const char*)((size_t)s & ~(size_t)15);
+    unsigned int mask = 0;
+    const char* q;
+    __m128i b, m;
+    int i;
+
+    if (!count)
+        return find_chars_or_comment(s, chars);
+    for (i = 0; i < count; i++)
+        needles[i] = _mm_set1_epi8(bytes[i]);
+
+    for (;;) {
+        while (!mask) {
+            b = _mm_load_si128((const __m128i*)p);
+            m = _mm_cmpeq_epi8(b, needles[0]);
+            for (i = 1; i < count; i++)
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(b, needles[i]));
+            mask = (unsigned int)_mm_movemask_epi8(m);
+            if (p < s)
+                mask &= ~0u << (s - p);
+            p += 16;
+        }
+        q = p - 16 + __builtin_ctz(mask);
+        if (is_chars_or_comment(s, q, chars))
+            return (char*)q;
+        mask &= mask - 1;
+    }
+}
+
+/* Bitmask of bytes in 32-byte block which are not ASCII whitespace, see
+   nonspace_mask_sse2(). */
+INI_SIMD_FUNCTION("avx2")
+static unsigned int nonspace_mask_avx2(const char* p)
+{
+    __m256i b = _mm256_load_si256((const __m256i*)p);
+    __m256i t = _mm256_sub_epi8(b, _mm256_set1_epi8(9));
+    __m256i space = _mm256_or_si256(
+        _mm256_cmpeq_epi8(b, _mm256_set1_epi8(' ')),
+        _mm256_cmpeq_epi8(_mm256_min_epu8(t, _mm256_set1_epi8(4)), t));
+    return ~(unsigned int)_mm256_movemask_epi8(space);
+}
+
+/* AVX2 version of lskip(), scans 32 bytes at a time. */
+INI_SIMD_FUNCTION("avx2")
+static char* lskip_avx2(const char* s)
+{
+    const char* p = (const char*)((size_t)s & ~(size_t)31);
+    unsigned int mask = nonspace_mask_avx2(p) & (~0u << (s - p));
+    const char* q;
+
+    for (;;) {
+        while (!mask) {
+            p += 32;
+            mask = nonspace_mask_avx2(p);
+        }
+        q = p + __builtin_ctz(mask);
+        if (!*q || !isspace((unsigned char)*q))
+            return (char*)q;
+        mask &= mask - 1;
+    }
+}
+
+/* AVX2 version of find_chars_or_comment(), scans 32 bytes at a time. */
+INI_SIMD_FUNCTION("avx2")
+static char* find_chars_or_comment_avx2(const char* s, const char* chars)
+{
+    char bytes[MAX_NEEDLES];
+    __m256i needles[MAX_NEEDLES];
+    int count = collect_needles(bytes, chars);
+    const char* p = (const char*)((size_t)s & ~(size_t)31);
+    unsigned int mask = 0;
+    const char* q;
+    __m256i b, m;
+    int i;
+
+    if (!count)
+        return find_chars_or_comment(s, chars);
+    for (i = 0; i < count; i++)
+        needles[i] = _mm256_set1_epi8(bytes[i]);
+
+    for (;;) {
+        while (!mask) {
+            b = _mm256_load_si256((const __m256i*)p);
+            m = _mm256_cmpeq_epi8(b, needles[0]);
+            for (i = 1; i < count; i++)
+                m = _mm256_or_si256(m, _mm256_cmpeq_epi8(b, needles[i]));
+            mask = (unsigned int)_mm256_movemask_epi8(m);
+            if (p < s)
+                mask &= ~0u << (s - p);
+            p += 32;
+        }
+        q = p - 32 + __builtin_ctz(mask);
+        if (is_chars_or_comment(s, q, chars))
+            return (char*)q;
+        mask &= mask - 1;
+    }
+}
+
+#endif /* INI_HAVE_SIMD */
+
+/* Set of line scanning functions */
+typedef struct {
+    char* (*lskip)(const char* s);
+    char* (*find_chars_or_comment)(const char* s, const char* chars);
+} ini_scanner;
+
+static const ini_scanner scalar_scanner = { lskip, find_chars_or_comment };
+#if INI_HAVE_SIMD
+static const ini_scanner sse2_scanner = {
+    lskip_sse2, find_chars_or_comment_sse2
+};
+static const ini_scanner avx2_scanner = {
+    lskip_avx2, find_chars_or_comment_avx2
+};
+#endif
+
+/* Return fastest line scanner supported by CPU. */
+static const ini_scanner* select_scanner(void)
+{
+#if INI_HAVE_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return &avx2_scanner;
+    if (__builtin_cpu_supports("sse2"))
+        return &sse2_scanner;
+#endif
+    return &scalar_scanner;
+}
+
+/* Copy name into buffer *dest of *size bytes, which initially is array of
+   initial_size bytes. Grow buffer if INI_ALLOW_REALLOC is nonzero, otherwise
+   truncate name. Return zero on success, nonzero on memory error. */
+static int copy_name(char** dest, size_t* size, size_t initial_size,
+                     const char* src)
+{
+#if INI_ALLOW_REALLOC
+    size_t length = strlen(src) + 1;
+    char* buffer;
+
+    if (length > *size) {
+        /* Old contents are overwritten, so there is nothing to reallocate */
+        buffer = (char*)ini_malloc(length);
+        if (!buffer)
+            return -1;
+        if (*size > initial_size)
+            ini_free(*dest);
+        *dest = buffer;
+        *size = length;
+    }
+    memcpy(*dest, src, length);
+#else
+    (void)initial_size;
+    strncpy(*dest, src, *size);
+    (*dest)[*size - 1] = '\0';
+#endif
+    return 0;
+}
+
+/* Parser state shared by stream and in-place parsers */
+typedef struct {
+    const ini_scanner* scanner;
+    ini_handler handler;
+    void* user;
+    char* section;          /* current section name */
+    char* prev_name;        /* name of the previous name=value pair */
+    size_t section_size;    /* sizes of section and prev_name buffers */
+    size_t prev_name_size;
+    int copy_names;         /* nonzero to copy names into section and prev_name,
+                               zero to point them into parsed text */
+    int lineno;
+    int error;
+} ini_parser;
+
+/* Parse single line of INI file. Line may be modified in place. */
+static void parse_line(ini_parser* parser, char* line)
 {
-    strncpy(dest, src, size);
-    dest[size - 1] = '\0';
-    return dest;
+    char* start;
+    char* end;
+    char* name;
+    char* value;
+
+    parser->lineno++;
+
+    start = line;
+#if INI_ALLOW_BOM
+    if (parser->lineno == 1 && (unsigned char)start[0] == 0xEF &&
+                               (unsigned char)start[1] == 0xBB &&
+                               (unsigned char)start[2] == 0xBF) {
+        start += 3;
+    }
+#endif
+    start = parser->scanner->lskip(rstrip(start));
+
+    if (*start == ';' || *start == '#') {
+        /* Per Python configparser, allow both ; and # comments at the
+           start of a line */
+    }
+#if INI_ALLOW_MULTILINE
+    else if (*parser->prev_name && *start && start > line) {
+        /* Non-blank line with leading whitespace, treat as continuation
+           of previous name's value (as per Python configparser). */
+#if INI_MULTILINE_NULL_NAME
+        if (!parser->handler(parser->user, parser->section, NULL, start) &&
+            !parser->error)
+#else
+        if (!parser->handler(parser->user, parser->section,
+                             parser->prev_name, start) && !parser->error)
+#endif
+            parser->error = parser->lineno;
+    }
+#endif
+    else if (*start == '[') {
+        /* A "[section]" line */
+        end = parser->scanner->find_chars_or_comment(start + 1, "]");
+        if (*end == ']') {
+            *end = '\0';
+            if (parser->copy_names) {
+                if (copy_name(&parser->section, &parser->section_size,
+                              MAX_SECTION, start + 1) != 0) {
+                    parser->error = -2;
+                    return;
+                }
+                *parser->prev_name = '\0';
+            }
+            else {
+                parser->section = start + 1;
+                parser->prev_name = end;
+            }
+        }
+        else if (!parser->error) {
+            /* No ']' found on section line */
+            parser->error = parser->lineno;
+        }
+    }
+    else if (*start) {
+        /* Not a comment, must be a name[=:]value pair */
+        end = parser->scanner->find_chars_or_comment(start, "=:");
+        if (*end == '=' || *end == ':') {
+            *end = '\0';
+            name = rstrip(start);
+            value = parser->scanner->lskip(end + 1);
+#if INI_ALLOW_INLINE_COMMENTS
+            end = parser->scanner->find_chars_or_comment(value, NULL);
+            if (*end)
+                *end = '\0';
+#endif
+            rstrip(value);
+
+            /* Valid name[=:]value pair found, call handler */
+            if (parser->copy_names) {
+                if (copy_name(&parser->prev_name, &parser->prev_name_size,
+                              MAX_NAME, name) != 0) {
+                    parser->error = -2;
+                    return;
+                }
+            }
+            else
+                parser->prev_name = name;
+            if (!parser->handler(parser->user, parser->section, name, value) &&
+                !parser->error)
+                parser->error = parser->lineno;
+        }
+        else if (!parser->error) {
+            /* No '=' or ':' found on name[=:]value line */
+            parser->error = parser->lineno;
+        }
+    }
 }
 
 /* See documentation in header file. */
@@ -81,96 +466,131 @@ int ini_parse_stream(ini_reader reader, void* stream, ini_handler handler,
 #endif
     char section[MAX_SECTION] = "";
     char prev_name[MAX_NAME] = "";
-
-    char* start;
-    char* end;
-    char* name;
-    char* value;
-    int lineno = 0;
-    int error = 0;
+    ini_parser parser;
+#if INI_ALLOW_REALLOC
+    size_t max_line = INI_MAX_LINE;
+    size_t offset = 0;
+    size_t chunk;
+    size_t length;
+    char* new_line;
+#endif
 
 #if !INI_USE_STACK
-    line = (char*)malloc(INI_MAX_LINE);
+    line = (char*)ini_malloc(INI_MAX_LINE);
     if (!line) {
         return -2;
     }
 #endif
 
-    /* Scan through stream line by line */
-    while (reader(line, INI_MAX_LINE, stream) != NULL) {
-        lineno++;
+    parser.scanner = select_scanner();
+    parser.handler = handler;
+    parser.user = user;
+    parser.section = section;
+    parser.prev_name = prev_name;
+    parser.section_size = MAX_SECTION;
+    parser.prev_name_size = MAX_NAME;
+    parser.copy_names = 1;
+    parser.lineno = 0;
+    parser.error = 0;
 
-        start = line;
-#if INI_ALLOW_BOM
-        if (lineno == 1 && (unsigned char)start[0] == 0xEF &&
-                           (unsigned char)start[1] == 0xBB &&
-                           (unsigned char)start[2] == 0xBF) {
-            start += 3;
-        }
-#endif
-        start = lskip(rstrip(start));
-
-        if (*start == ';' || *start == '#') {
-            /* Per Python configparser, allow both ; and # comments at the
-               start of a line */
-        }
-#if INI_ALLOW_MULTILINE
-        else if (*prev_name && *start && start > line) {
-            /* Non-blank line with leading whitespace, treat as continuation
-               of previous name's value (as per Python configparser). */
-            if (!handler(user, section, prev_name, start) && !error)
-                error = lineno;
+#if INI_ALLOW_REALLOC
+    /* Read stream in chunks appended to the line until it ends with newline,
+       growing line buffer geometrically, so that only new chunk is scanned */
+    for (;;) {
+        chunk = max_line - offset;
+        if (chunk > INT_MAX)
+            chunk = INT_MAX;
+        if (reader(line + offset, (int)chunk, stream) == NULL) {
+            /* Parse last line which was not terminated by newline */
+            if (offset > 0)
+                parse_line(&parser, line);
+            break;
         }
-#endif
-        else if (*start == '[') {
-            /* A "[section]" line */
-            end = find_chars_or_comment(start + 1, "]");
-            if (*end == ']') {
-                *end = '\0';
-                strncpy0(section, start + 1, sizeof(section));
-                *prev_name = '\0';
-            }
-            else if (!error) {
-                /* No ']' found on section line */
-                error = lineno;
+        length = strlen(line + offset);
+        offset += length;
+        if (length == chunk - 1 && line[offset - 1] != '\n') {
+            if (max_line - offset < 2) {
+                new_line = (char*)ini_realloc(line, max_line * 2);
+                if (!new_line) {
+                    parser.error = -2;
+                    break;
+                }
+                line = new_line;
+                max_line *= 2;
             }
+            continue;
         }
-        else if (*start) {
-            /* Not a comment, must be a name[=:]value pair */
-            end = find_chars_or_comment(start, "=:");
-            if (*end == '=' || *end == ':') {
-                *end = '\0';
-                name = rstrip(start);
-                value = lskip(end + 1);
-#if INI_ALLOW_INLINE_COMMENTS
-                end = find_chars_or_comment(value, NULL);
-                if (*end)
-                    *end = '\0';
+        offset = 0;
+        parse_line(&parser, line);
+
+        if (parser.error < 0)
+            break;
+#if INI_STOP_ON_FIRST_ERROR
+        if (parser.error)
+            break;
 #endif
-                rstrip(value);
+    }
 
-                /* Valid name[=:]value pair found, call handler */
-                strncpy0(prev_name, name, sizeof(prev_name));
-                if (!handler(user, section, name, value) && !error)
-                    error = lineno;
-            }
-            else if (!error) {
-                /* No '=' or ':' found on name[=:]value line */
-                error = lineno;
-            }
-        }
+    if (parser.section_size > MAX_SECTION)
+        ini_free(parser.section);
+    if (parser.prev_name_size > MAX_NAME)
+        ini_free(parser.prev_name);
+#else
+    /* Scan through stream line by line */
+    while (reader(line, INI_MAX_LINE, stream) != NULL) {
+        parse_line(&parser, line);
 
 #if INI_STOP_ON_FIRST_ERROR
-        if (error)
+        if (parser.error)
             break;
 #endif
     }
+#endif
 
 #if !INI_USE_STACK
-    free(line);
+    ini_free(line);
 #endif
 
-    return error;
+    return parser.error;
+}
+
+/* See documentation in header file. */
+int ini_parse_buffer(char* buffer, size_t length, ini_handler handler,
+                     void* user)
+{
+    char* line = buffer;
+    char* end = buffer + length;
+    char* eol;
+    ini_parser parser;
+
+    parser.scanner = select_scanner();
+    parser.handler = handler;
+    parser.user = user;
+    parser.section = end;
+    parser.prev_name = end;
+    parser.copy_names = 0;
+    parser.lineno = 0;
+    parser.error = 0;
+
+    /* Terminate buffer, so empty section and name can point to its end */
+    *end = '\0';
+
+    /* Scan through buffer line by line, terminating each line in place */
+    while (line < end) {
+        eol = (char*)memchr(line, '\n', end - line);
+        if (!eol)
+            eol = end;
+        *eol = '\0';
+        parse_line(&parser, line);
+        line = eol + 1;
+
+#if INI_STOP_ON_FIRST_ERROR
+        if (parser.error)
+            break;
+#endif
+    }
+
+    return parser.error;
 }
 
 /* See documentation in header file. */
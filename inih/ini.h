@@ -48,13 +48,28 @@ int ini_parse_file(FILE* file, ini_handler handler, void* user);
 int ini_parse_stream(ini_reader reader, void* stream, ini_handler handler,
                      void* user);
 
+/* Same as ini_parse(), but parses given buffer of length bytes in place.
+   Buffer must have room for terminating null at buffer[length], it doesn't
+   need to be null-terminated on input. Buffer contents are modified, and
+   section, name, and value passed to handler point into the buffer, so they
+   remain valid for as long as the buffer does. */
+int ini_parse_buffer(char* buffer, size_t length, ini_handler handler,
+                     void* user);
+
 /* Nonzero to allow multi-line value parsing, in the style of Python's
    configparser. If allowed, ini_parse() will call the handler with the same
-   name for each subsequent line parsed. */
+   name, or NULL name, see below, for each subsequent line parsed. */
 #ifndef INI_ALLOW_MULTILINE
 #define INI_ALLOW_MULTILINE 1
 #endif
 
+/* Nonzero to call the handler with NULL name for continuation lines of
+   multi-line values, so that it can append them to the previous value, zero
+   to call it with the same name as for the first line. */
+#ifndef INI_MULTILINE_NULL_NAME
+#define INI_MULTILINE_NULL_NAME 1
+#endif
+
 /* Nonzero to allow a UTF-8 BOM sequence (0xEF 0xBB 0xBF) at the start of
    the file. See http://code.google.com/p/inih/issues/detail?id=21 */
 #ifndef INI_ALLOW_BOM
@@ -76,12 +91,36 @@ int ini_parse_stream(ini_reader reader, void* stream, ini_handler handler,
 #define INI_USE_STACK 1
 #endif
 
+/* Nonzero to grow heap line buffer with ini_realloc, so that length of lines,
+   section names and names is not limited (INI_USE_STACK must be 0). Zero to
+   split lines longer than INI_MAX_LINE and truncate section names and names
+   to 50 characters. */
+#ifndef INI_ALLOW_REALLOC
+#define INI_ALLOW_REALLOC (!INI_USE_STACK)
+#endif
+
+/* Nonzero to use custom ini_malloc, ini_free, and ini_realloc memory
+   allocation functions (INI_USE_STACK must also be 0). These functions must
+   have the same signatures as malloc/free/realloc and behave in a similar
+   way, and must be defined by the application. */
+#ifndef INI_CUSTOM_ALLOCATOR
+#define INI_CUSTOM_ALLOCATOR 0
+#endif
+
+/* Nonzero to scan lines with SSE2 or AVX2 instructions when compiled with
+   GCC-compatible compiler for x86 and CPU supports them, zero to always use
+   portable byte-by-byte scanning. Both produce identical results. */
+#ifndef INI_USE_SIMD
+#define INI_USE_SIMD 1
+#endif
+
 /* Stop parsing on first error (default is to keep parsing). */
 #ifndef INI_STOP_ON_FIRST_ERROR
 #define INI_STOP_ON_FIRST_ERROR 0
 #endif
 
-/* Maximum line length for any line in INI file. */
+/* Maximum line length for any line in INI file, or initial size of line
+   buffer if INI_ALLOW_REALLOC is nonzero. */
 #ifndef INI_MAX_LINE
 #define INI_MAX_LINE 200
 #endif
@@ -0,0 +1,310 @@
+/*=======================================================================================
+
+TinyINI - small and simple open-source library for loading, saving and
+managing INI file data structures in the memory.
+
+TinyINI is distributed under following terms and conditions:
+
+Copyright (c) 2015-2016, Ivan Pizhenko.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ''AS IS''
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL BEN HOYT BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+SPECIAL NOTICE
+TinyINI library relies on the open-source INIH library
+(https://github.com/benhoyt/inih) for parsing text of INI file.
+Source code of INIH library and information about it, including
+licensing conditions, is included in the subfolder inih.
+
+=======================================================================================*/
+
+
+/* Randomized test of the INI file edit engine. Sections and parameters are added, replaced 
+ * and removed at random, and the INI file object is compared with a simple model after 
+ * every step: lookups, storage views, element counts, dump order, compaction and 
+ * staleness of parameter handles.
+ */
+
+#include "tini/tini.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ROUNDS 200
+#define STEPS_PER_ROUND 3000
+#define SECTION_NAMES 24
+#define KEY_NAMES 64
+#define NAME_SIZE 8
+#define VALUE_SIZE 16
+
+/* Model of a section: parameters in insertion order */
+typedef struct {
+	char name[NAME_SIZE];
+	int count;
+	char keys[KEY_NAMES][NAME_SIZE];
+	char values[KEY_NAMES][VALUE_SIZE];
+} model_section;
+
+/* Model of INI file object: sections in creation order */
+typedef struct {
+	int count;
+	model_section sections[SECTION_NAMES];
+} model_ini;
+
+static model_ini model;
+static unsigned long long random_state = 0x2545F4914F6CDD1DULL;
+static long checks;
+
+static unsigned int next_random(void) {
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return (unsigned int)(random_state >> 32);
+}
+
+static int fail(const char* what, int round, int step) {
+	fprintf(stderr, "%s mismatch: round %d, step %d\n", what, round, step);
+	return 1;
+}
+
+static model_section* model_find_section(const char* name) {
+	int i;
+	for (i = 0; i < model.count; ++i) {
+		if (strcmp(model.sections[i].name, name) == 0)
+			return model.sections + i;
+	}
+	return NULL;
+}
+
+static int model_find_key(const model_section* section, const char* key) {
+	int i;
+	for (i = 0; i < section->count; ++i) {
+		if (strcmp(section->keys[i], key) == 0)
+			return i;
+	}
+	return -1;
+}
+
+static int model_add(const char* section_name, const char* key, const char* value, int replace) {
+	model_section* section = model_find_section(section_name);
+	int i;
+	if (!section) {
+		section = model.sections + model.count++;
+		strcpy(section->name, section_name);
+		section->count = 0;
+	}
+	i = model_find_key(section, key);
+	if (i < 0) {
+		strcpy(section->keys[section->count], key);
+		strcpy(section->values[section->count++], value);
+	} else if (replace)
+		strcpy(section->values[i], value);
+	else
+		return -1;
+	return 0;
+}
+
+static int model_remove_parameter(const char* section_name, const char* key) {
+	model_section* section = model_find_section(section_name);
+	int i = section ? model_find_key(section, key) : -1;
+	if (i < 0)
+		return -1;
+	--section->count;
+	memmove(section->keys[i], section->keys[i + 1], sizeof(section->keys[0]) * (section->count - i));
+	memmove(section->values[i], section->values[i + 1], sizeof(section->values[0]) * (section->count - i));
+	return 0;
+}
+
+static int model_remove_section(const char* section_name) {
+	model_section* section = model_find_section(section_name);
+	if (!section)
+		return -1;
+	--model.count;
+	memmove(section, section + 1, sizeof(model_section) * (model.sections + model.count - section));
+	return 0;
+}
+
+static char* model_dump(void) {
+	/* Same format as tini_dump_to_buffer */
+	char* text = malloc((size_t)SECTION_NAMES * (NAME_SIZE + 4 + KEY_NAMES * (NAME_SIZE + VALUE_SIZE + 2)) + 1);
+	char* p = text;
+	int i, j;
+	if (!text)
+		return NULL;
+	for (i = 0; i < model.count; ++i) {
+		const model_section* section = model.sections + i;
+		p += sprintf(p, "[%s]\n", section->name);
+		for (j = 0; j < section->count; ++j)
+			p += sprintf(p, "%s=%s\n", section->keys[j], section->values[j]);
+		*p++ = '\n';
+	}
+	*p = '\0';
+	return text;
+}
+
+static int check_views(const ini_file* ini) {
+	/* Views are dense, terminated by NULL and agree with counts and the model */
+	const ini_section* const* sections = tini_get_sections(ini);
+	int i, j;
+	if (!sections || tini_get_section_count(ini) != (size_t)model.count)
+		return 0;
+	for (i = 0; i < model.count; ++i) {
+		const model_section* expected = model.sections + i;
+		const ini_section* section = sections[i];
+		const char* const* keys;
+		const char* const* values;
+		if (!section || section != tini_find_section(ini, expected->name))
+			return 0;
+		keys = tini_get_keys(section);
+		values = tini_get_values(section);
+		if (!keys || !values || tini_get_parameter_count(section) != (size_t)expected->count)
+			return 0;
+		for (j = 0; j < expected->count; ++j) {
+			if (!keys[j] || !values[j] || strcmp(keys[j], expected->keys[j]) != 0 
+				|| strcmp(values[j], expected->values[j]) != 0)
+				return 0;
+		}
+		if (keys[j] || values[j])
+			return 0;
+	}
+	return 1;
+}
+
+static int check_dump(const ini_file* ini) {
+	char* text = tini_dump_to_buffer(ini, NULL);
+	char* expected = model_dump();
+	int res = text && expected && strcmp(text, expected) == 0;
+	free(text);
+	free(expected);
+	return res;
+}
+
+static int run_round(int round, unsigned int flags) {
+	ini_file* ini = tini_create_ini_ex(flags);
+	ini_parameter_handle handle;
+	char handle_value[VALUE_SIZE];
+	int has_handle = 0, step;
+	if (!ini) {
+		perror("tini_create_ini_ex");
+		return 1;
+	}
+	model.count = 0;
+	
+	for (step = 0; step < STEPS_PER_ROUND; ++step) {
+		char section[NAME_SIZE], key[NAME_SIZE], value[VALUE_SIZE];
+		unsigned int op = next_random() % 100;
+		const model_section* expected;
+		int i;
+		/* Few section names make sections large, so that removals leave many tombstones */
+		sprintf(section, "s%u", next_random() % (round % 2 ? SECTION_NAMES : 4));
+		sprintf(key, "k%u", next_random() % KEY_NAMES);
+		sprintf(value, "v%d", step);
+		expected = model_find_section(section);
+		i = expected ? model_find_key(expected, key) : -1;
+		
+		if (op < 45) {
+			/* Add or replace parameter. Handle survives, unless compaction of full storage moved it. */
+			int replace = (int)(next_random() % 4 != 0);
+			if ((tini_add_parameter(ini, section, key, value, replace) == 0) != (model_add(section, key, value, replace) == 0))
+				return fail("add", round, step);
+			if (has_handle) {
+				const char* v = tini_value_by_handle(ini, &handle);
+				if (v && strcmp(v, handle_value) != 0 && !(i >= 0 && replace))
+					return fail("handle after add", round, step);
+				has_handle = 0;
+			}
+		} else if (op < 70) {
+			/* Remove parameter, handles become stale */
+			int res = tini_remove_parameter(ini, section, key);
+			if ((res == 0) != (model_remove_parameter(section, key) == 0))
+				return fail("remove parameter", round, step);
+			if (res == 0 && has_handle && tini_value_by_handle(ini, &handle) != NULL)
+				return fail("stale handle", round, step);
+			if (res == 0)
+				has_handle = 0;
+		} else if (op < 74) {
+			/* Remove section, handles become stale */
+			int res = tini_remove_section(ini, section);
+			if ((res == 0) != (model_remove_section(section) == 0))
+				return fail("remove section", round, step);
+			if (res == 0 && has_handle && tini_value_by_handle(ini, &handle) != NULL)
+				return fail("stale handle", round, step);
+			if (res == 0)
+				has_handle = 0;
+		} else if (op < 88) {
+			/* Find parameter and resolve handle to it */
+			const char* v = tini_find_parameter(ini, section, key, NULL);
+			if ((v != NULL) != (i >= 0) || (v && strcmp(v, expected->values[i]) != 0))
+				return fail("find", round, step);
+			if ((tini_find_section(ini, section) != NULL) != (expected != NULL))
+				return fail("find section", round, step);
+			if (v) {
+				if (tini_resolve(ini, section, key, &handle) != 0)
+					return fail("resolve", round, step);
+				strcpy(handle_value, v);
+				has_handle = 1;
+			}
+		} else if (op < 94) {
+			/* Views and counts */
+			if (!check_views(ini))
+				return fail("views", round, step);
+		} else if (op < 98) {
+			/* Dump order */
+			if (!check_dump(ini))
+				return fail("dump", round, step);
+		} else {
+			/* Compaction changes neither content nor order */
+			tini_compact(ini);
+			if (!check_views(ini) || !check_dump(ini))
+				return fail("compact", round, step);
+			if (has_handle) {
+				const char* v = tini_value_by_handle(ini, &handle);
+				if (v && strcmp(v, handle_value) != 0)
+					return fail("handle after compact", round, step);
+				has_handle = 0;
+			}
+		}
+		
+		/* Reads never invalidate handles */
+		if (has_handle && op >= 74) {
+			const char* v = tini_value_by_handle(ini, &handle);
+			if (!v || strcmp(v, handle_value) != 0)
+				return fail("handle after read", round, step);
+		}
+		++checks;
+	}
+	
+	if (!check_views(ini) || !check_dump(ini))
+		return fail("final", round, ROUNDS);
+	tini_free_ini(ini);
+	return 0;
+}
+
+int main(void) {
+	int round, failures = 0;
+	for (round = 0; round < ROUNDS && failures == 0; ++round)
+		failures += run_round(round, round % 4 == 3 ? TINI_FLAG_USE_ARENA : 0);
+	printf("steps %ld\n", checks);
+	printf("%s\n", failures == 0 ? "ok" : "FAILED");
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
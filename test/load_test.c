@@ -0,0 +1,322 @@
+/*=======================================================================================
+
+TinyINI - small and simple open-source library for loading, saving and
+managing INI file data structures in the memory.
+
+TinyINI is distributed under following terms and conditions:
+
+Copyright (c) 2015-2016, Ivan Pizhenko.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ''AS IS''
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL BEN HOYT BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+SPECIAL NOTICE
+TinyINI library relies on the open-source INIH library
+(https://github.com/benhoyt/inih) for parsing text of INI file.
+Source code of INIH library and information about it, including
+licensing conditions, is included in the subfolder inih.
+
+=======================================================================================*/
+
+
+/* Differential test of loaders. INI files are generated and edited at random, and objects 
+ * built by incremental reload, parallel loader and directory loader must dump exactly the 
+ * same text as objects loaded by tini_load_ini_from_buffer from the same text.
+ */
+
+#include "tini/tini.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_LINES 400
+#define LINE_SIZE 64
+#define RELOAD_ROUNDS 300
+#define RELOAD_STEPS 30
+#define PARALLEL_ROUNDS 300
+#define DIR_ROUNDS 100
+#define DIR_FILES 6
+
+/* INI file text as array of lines */
+typedef struct {
+	int count;
+	char lines[MAX_LINES][LINE_SIZE];
+	const char* eol;
+	int last_eol;
+} ini_text;
+
+static unsigned long long random_state = 0x6A09E667F3BCC909ULL;
+
+static unsigned int next_random(void) {
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return (unsigned int)(random_state >> 32);
+}
+
+static void generate_line(char* line) {
+	/* Few names, so that sections and parameters repeat, with continuation lines and comments */
+	unsigned int kind = next_random() % 10;
+	if (kind < 2)
+		sprintf(line, "[s%u]", next_random() % 6);
+	else if (kind < 3)
+		sprintf(line, "%scont%u", next_random() % 2 ? "  " : "\t", next_random() % 3);
+	else if (kind < 4)
+		strcpy(line, next_random() % 2 ? "; comment" : "");
+	else
+		sprintf(line, "k%u%sv%u", next_random() % 4, next_random() % 2 ? "=" : " : ", next_random() % 3);
+}
+
+static void generate_text(ini_text* text, int count) {
+	int i;
+	text->count = count;
+	for (i = 0; i < count; ++i)
+		generate_line(text->lines[i]);
+	text->eol = next_random() % 4 == 0 ? "\r\n" : "\n";
+	text->last_eol = (int)(next_random() % 4 != 0);
+}
+
+static void edit_text(ini_text* text) {
+	/* Insert, remove, replace or swap lines, or duplicate block of lines */
+	int count = text->count;
+	switch (next_random() % 5) {
+	case 0:
+		if (count < MAX_LINES) {
+			int at = (int)(next_random() % (count + 1));
+			memmove(text->lines[at + 1], text->lines[at], (size_t)(count - at) * LINE_SIZE);
+			generate_line(text->lines[at]);
+			++text->count;
+		}
+		break;
+	case 1:
+		if (count > 0) {
+			int at = (int)(next_random() % count);
+			memmove(text->lines[at], text->lines[at + 1], (size_t)(count - at - 1) * LINE_SIZE);
+			--text->count;
+		}
+		break;
+	case 2:
+		if (count > 0)
+			generate_line(text->lines[next_random() % count]);
+		break;
+	case 3:
+		if (count > 0) {
+			int from = (int)(next_random() % count), length = 1 + (int)(next_random() % 8);
+			int at = (int)(next_random() % (count + 1)), i;
+			if (from + length > count)
+				length = count - from;
+			if (count + length <= MAX_LINES) {
+				memmove(text->lines[at + length], text->lines[at], (size_t)(count - at) * LINE_SIZE);
+				text->count += length;
+				for (i = 0; i < length; ++i)
+					memcpy(text->lines[at + i], text->lines[from + i + (from + i >= at ? length : 0)], LINE_SIZE);
+			}
+		}
+		break;
+	default:
+		if (count > 1) {
+			char line[LINE_SIZE];
+			int a = (int)(next_random() % count), b = (int)(next_random() % count);
+			memcpy(line, text->lines[a], LINE_SIZE);
+			memcpy(text->lines[a], text->lines[b], LINE_SIZE);
+			memcpy(text->lines[b], line, LINE_SIZE);
+		}
+		break;
+	}
+}
+
+static char* join_text(const ini_text* text, size_t* length) {
+	char* buffer = malloc((size_t)text->count * (LINE_SIZE + 2) + 1);
+	char* p = buffer;
+	int i;
+	if (!buffer)
+		return NULL;
+	for (i = 0; i < text->count; ++i)
+		p += sprintf(p, "%s%s", text->lines[i], i + 1 < text->count || text->last_eol ? text->eol : "");
+	*length = (size_t)(p - buffer);
+	return buffer;
+}
+
+static int write_text(const char* path, const char* buffer, size_t length) {
+	FILE* f = fopen(path, "wb");
+	if (!f)
+		return -1;
+	if (fwrite(buffer, 1, length, f) != length) {
+		fclose(f);
+		return -1;
+	}
+	return fclose(f) == 0 ? 0 : -1;
+}
+
+static int same_ini(const char* what, const ini_file* ini, const char* buffer, size_t length) {
+	/* Compare dump of given object with dump of the object loaded from the text */
+	ini_file* expected = tini_load_ini_from_buffer(buffer, length);
+	char* text = ini ? tini_dump_to_buffer(ini, NULL) : NULL;
+	char* expected_text = expected ? tini_dump_to_buffer(expected, NULL) : NULL;
+	int res = text && expected_text && strcmp(text, expected_text) == 0;
+	if (!res) {
+		fprintf(stderr, "%s mismatch\n--- text\n%.*s\n--- expected\n%s--- actual\n%s", what, (int)length, buffer, 
+			expected_text ? expected_text : "(null)\n", text ? text : "(null)\n");
+	}
+	free(text);
+	free(expected_text);
+	tini_free_ini(expected);
+	return res;
+}
+
+static int test_reload(const char* dir) {
+	/* Reload edited file into the same object, which may also be edited between reloads */
+	static ini_text text;
+	char path[256];
+	int round, step;
+	sprintf(path, "%s/reload.ini", dir);
+	for (round = 0; round < RELOAD_ROUNDS; ++round) {
+		ini_file* ini = tini_create_ini();
+		if (!ini)
+			return 0;
+		generate_text(&text, (int)(next_random() % 60));
+		for (step = 0; step < RELOAD_STEPS; ++step) {
+			size_t length;
+			char* buffer;
+			int res;
+			edit_text(&text);
+			buffer = join_text(&text, &length);
+			if (!buffer || write_text(path, buffer, length) != 0)
+				return 0;
+			if (next_random() % 4 == 0)
+				tini_add_parameter(ini, "s1", "k0", "edited", 1);
+			if (next_random() % 6 == 0)
+				tini_remove_section(ini, "s2");
+			if (next_random() % 6 == 0)
+				tini_remove_parameter(ini, "s3", "k1");
+			res = tini_reload_ini(ini, path) == 0 && same_ini("reload", ini, buffer, length);
+			free(buffer);
+			if (!res) {
+				tini_free_ini(ini);
+				return 0;
+			}
+		}
+		tini_free_ini(ini);
+	}
+	unlink(path);
+	return 1;
+}
+
+static int test_parallel_load(const char* dir) {
+	/* Chunks are small, so that files are split at many places */
+	static ini_text text;
+	char path[256];
+	int round;
+	sprintf(path, "%s/parallel.ini", dir);
+	for (round = 0; round < PARALLEL_ROUNDS; ++round) {
+		size_t length;
+		char* buffer;
+		ini_file* ini;
+		int res;
+		generate_text(&text, (int)(next_random() % MAX_LINES));
+		buffer = join_text(&text, &length);
+		if (!buffer || write_text(path, buffer, length) != 0)
+			return 0;
+		ini = tini_load_ini_parallel(path, 1 + next_random() % 8);
+		res = same_ini("parallel load", ini, buffer, length);
+		tini_free_ini(ini);
+		free(buffer);
+		if (!res)
+			return 0;
+	}
+	unlink(path);
+	return 1;
+}
+
+static int test_load_dir(const char* dir) {
+	/* Files start with section header and end with line break, so that loading them one 
+	 * after another is the same as loading their concatenation in the lexical order
+	 */
+	static ini_text text;
+	char path[256];
+	int round, i;
+	for (round = 0; round < DIR_ROUNDS; ++round) {
+		char* joined = NULL;
+		size_t joined_length = 0;
+		ini_file_status* statuses = NULL;
+		size_t status_count = 0;
+		ini_file* ini;
+		int file_count = 1 + (int)(next_random() % DIR_FILES), res;
+		for (i = 0; i < file_count; ++i) {
+			size_t length;
+			char* buffer;
+			char* p;
+			generate_text(&text, 1 + (int)(next_random() % 80));
+			sprintf(text.lines[0], "[s%u]", next_random() % 6);
+			text.last_eol = 1;
+			buffer = join_text(&text, &length);
+			sprintf(path, "%s/f%d.ini", dir, i);
+			p = buffer ? realloc(joined, joined_length + length) : NULL;
+			if (!p || write_text(path, buffer, length) != 0)
+				return 0;
+			joined = p;
+			memcpy(joined + joined_length, buffer, length);
+			joined_length += length;
+			free(buffer);
+		}
+		ini = tini_load_dir(dir, "f*.ini", 1 + next_random() % 4, &statuses, &status_count);
+		res = same_ini("directory load", ini, joined, joined_length) && status_count == (size_t)file_count;
+		for (i = 0; i < (int)status_count && res; ++i)
+			res = statuses[i].error == 0;
+		tini_free_file_statuses(statuses, status_count);
+		tini_free_ini(ini);
+		free(joined);
+		for (i = 0; i < file_count; ++i) {
+			sprintf(path, "%s/f%d.ini", dir, i);
+			unlink(path);
+		}
+		if (!res)
+			return 0;
+	}
+	return 1;
+}
+
+int main(void) {
+	char dir[] = "/tmp/tini_load_test_XXXXXX";
+	int failures = 0;
+	if (!mkdtemp(dir)) {
+		perror("mkdtemp");
+		return EXIT_FAILURE;
+	}
+	if (!test_reload(dir)) {
+		fprintf(stderr, "incremental reload: FAILED\n");
+		++failures;
+	}
+	if (!test_parallel_load(dir)) {
+		fprintf(stderr, "parallel load: FAILED\n");
+		++failures;
+	}
+	if (!test_load_dir(dir)) {
+		fprintf(stderr, "directory load: FAILED\n");
+		++failures;
+	}
+	rmdir(dir);
+	printf("%s\n", failures == 0 ? "ok" : "FAILED");
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
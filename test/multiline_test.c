@@ -0,0 +1,310 @@
+/*=======================================================================================
+
+TinyINI - small and simple open-source library for loading, saving and
+managing INI file data structures in the memory.
+
+TinyINI is distributed under following terms and conditions:
+
+Copyright (c) 2015-2016, Ivan Pizhenko.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ''AS IS''
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL BEN HOYT BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+SPECIAL NOTICE
+TinyINI library relies on the open-source INIH library
+(https://github.com/benhoyt/inih) for parsing text of INI file.
+Source code of INIH library and information about it, including
+licensing conditions, is included in the subfolder inih.
+
+=======================================================================================*/
+
+
+/* Test of multi-line values. INI file with values of many continuation lines, including 
+ * one very long value, is generated at random. INIH must call the handler with NULL name 
+ * for continuation lines, and INI file objects loaded through the stream, arena, buffer, 
+ * in-place, dump and save/load paths must hold values joined with newlines.
+ */
+
+#include "tini/tini.h"
+#include "../inih/ini.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SECTIONS 40
+#define MAX_PARAMETERS 12
+#define MAX_CONTINUATION_LINES 8
+#define LONG_VALUE_LINES 50000
+
+/* Expected parameter */
+typedef struct {
+	int section;
+	char key[16];
+	char* value;
+	size_t length;
+	size_t size;
+} expected_parameter;
+
+static expected_parameter* expected;
+static size_t expected_count;
+static unsigned long long random_state = 0x9E3779B97F4A7C15ULL;
+
+static unsigned int next_random(void) {
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return (unsigned int)(random_state >> 32);
+}
+
+static int append(char** text, size_t* length, size_t* size, const char* s) {
+	size_t n = strlen(s);
+	while (*length + n + 1 > *size) {
+		char* p;
+		*size = *size ? *size * 2 : 256;
+		p = realloc(*text, *size);
+		if (!p)
+			return -1;
+		*text = p;
+	}
+	memcpy(*text + *length, s, n + 1);
+	*length += n;
+	return 0;
+}
+
+static char* generate_ini(size_t* text_length) {
+	/* Generate INI file text and expected joined values */
+	static const char* const indents[] = { " ", "\t", "    ", " \t " };
+	char* text = NULL;
+	size_t length = 0, size = 0;
+	int i, j, k;
+	expected = calloc((size_t)SECTIONS * MAX_PARAMETERS, sizeof(expected_parameter));
+	if (!expected)
+		return NULL;
+	for (i = 0; i < SECTIONS; ++i) {
+		char line[64];
+		int parameter_count = 1 + (int)(next_random() % MAX_PARAMETERS);
+		sprintf(line, "[section%d]\n", i);
+		if (append(&text, &length, &size, line) != 0)
+			return NULL;
+		for (j = 0; j < parameter_count; ++j) {
+			expected_parameter* p = expected + expected_count++;
+			int lines = (int)(next_random() % (MAX_CONTINUATION_LINES + 1));
+			if (i == SECTIONS / 2 && j == 0)
+				lines = LONG_VALUE_LINES;
+			p->section = i;
+			sprintf(p->key, "key%d", j);
+			sprintf(line, "w%u", next_random() % 100000);
+			if (append(&p->value, &p->length, &p->size, line) != 0)
+				return NULL;
+			sprintf(line, "%s = %s\n", p->key, p->value);
+			if (append(&text, &length, &size, line) != 0)
+				return NULL;
+			for (k = 0; k < lines; ++k) {
+				/* Continuation line is indented, and may end with whitespace */
+				char word[16];
+				sprintf(word, "w%u", next_random() % 100000);
+				sprintf(line, "%s%s%s\n", indents[next_random() % 4], word, next_random() % 8 == 0 ? " \t" : "");
+				if (append(&text, &length, &size, line) != 0 || append(&p->value, &p->length, &p->size, "\n") != 0 
+					|| append(&p->value, &p->length, &p->size, word) != 0)
+					return NULL;
+			}
+		}
+		if (append(&text, &length, &size, "\n") != 0)
+			return NULL;
+	}
+	*text_length = length;
+	return text;
+}
+
+/* Values collected by INIH handler: continuation lines with NULL name are appended to the last value */
+typedef struct {
+	size_t count;
+	int failed;
+} collected_values;
+
+static int collect_handler(void* user, const char* section, const char* name, const char* value) {
+	collected_values* collected = user;
+	expected_parameter* p;
+	char name_of_section[32];
+	if (!name) {
+		/* Continuation line of the last value */
+		if (collected->count == 0)
+			return 0;
+		p = expected + collected->count - 1;
+	} else {
+		if (collected->count == expected_count)
+			return 0;
+		p = expected + collected->count++;
+		sprintf(name_of_section, "section%d", p->section);
+		if (strcmp(section, name_of_section) != 0 || strcmp(name, p->key) != 0)
+			collected->failed = 1;
+		p->length = 0;
+	}
+	/* Value is rebuilt in place of the expected one, and compared at the end */
+	if (p->length != 0 && append(&p->value, &p->length, &p->size, "\n") != 0)
+		return 0;
+	if (append(&p->value, &p->length, &p->size, value) != 0)
+		return 0;
+	return 1;
+}
+
+static int check_handler_contract(const char* path, char* text, size_t length) {
+	/* Both stream and in-place parser pass continuation lines with NULL name */
+	char** saved = malloc(expected_count * sizeof(char*));
+	collected_values collected;
+	size_t i, round;
+	int res = 1;
+	if (!saved)
+		return 0;
+	for (i = 0; i < expected_count; ++i) {
+		saved[i] = strdup(expected[i].value);
+		if (!saved[i])
+			return 0;
+	}
+	for (round = 0; round < 2 && res; ++round) {
+		char* copy = malloc(length + 1);
+		if (!copy)
+			return 0;
+		memcpy(copy, text, length + 1);
+		collected.count = 0;
+		collected.failed = 0;
+		if ((round == 0 ? ini_parse(path, collect_handler, &collected) : ini_parse_buffer(copy, length, collect_handler, &collected)) != 0 
+			|| collected.failed || collected.count != expected_count)
+			res = 0;
+		for (i = 0; i < expected_count && res; ++i) {
+			if (strcmp(expected[i].value, saved[i]) != 0)
+				res = 0;
+		}
+		free(copy);
+	}
+	for (i = 0; i < expected_count; ++i) {
+		/* Restore expected values in case of partial failure */
+		expected[i].length = 0;
+		append(&expected[i].value, &expected[i].length, &expected[i].size, saved[i]);
+		free(saved[i]);
+	}
+	free(saved);
+	return res;
+}
+
+static int check_ini(const char* path_name, ini_file* ini) {
+	/* All values are joined, and continuation lines added no parameters */
+	size_t i, j;
+	int res = ini != NULL;
+	for (i = 0; i < expected_count && res; i = j) {
+		char section[32];
+		const char* const* keys;
+		sprintf(section, "section%d", expected[i].section);
+		for (j = i; j < expected_count && expected[j].section == expected[i].section; ++j) {
+			const char* value = tini_find_parameter(ini, section, expected[j].key, NULL);
+			if (!value || strcmp(value, expected[j].value) != 0)
+				res = 0;
+		}
+		keys = tini_find_section(ini, section) ? tini_get_keys(tini_find_section(ini, section)) : NULL;
+		if (!keys || keys[j - i] != NULL)
+			res = 0;
+	}
+	if (!res)
+		fprintf(stderr, "%s: values mismatch\n", path_name);
+	return res;
+}
+
+int main(void) {
+	char path[] = "/tmp/tini_multiline_XXXXXX";
+	char saved_path[] = "/tmp/tini_multiline_saved_XXXXXX";
+	size_t length, dump_length;
+	char* text = generate_ini(&length);
+	char* copy;
+	char* dump;
+	ini_file* ini;
+	FILE* f;
+	int fd, saved_fd, failures = 0;
+	size_t i;
+	if (!text) {
+		perror("generate_ini");
+		return EXIT_FAILURE;
+	}
+	fd = mkstemp(path);
+	saved_fd = mkstemp(saved_path);
+	if (fd < 0 || saved_fd < 0 || !(f = fdopen(fd, "w")) || fwrite(text, 1, length, f) != length || fclose(f) != 0) {
+		perror("mkstemp");
+		return EXIT_FAILURE;
+	}
+	close(saved_fd);
+	
+	failures += !check_handler_contract(path, text, length);
+	if (failures)
+		fprintf(stderr, "handler: continuation lines mismatch\n");
+	
+	/* Stream */
+	ini = tini_load_ini(path);
+	failures += !check_ini("stream", ini);
+	
+	/* Dump and save of the loaded object are loaded back with identical values */
+	dump = ini ? tini_dump_to_buffer(ini, &dump_length) : NULL;
+	if (dump) {
+		ini_file* dumped = tini_load_ini_from_buffer(dump, dump_length);
+		failures += !check_ini("dump", dumped);
+		tini_free_ini(dumped);
+		free(dump);
+	} else
+		failures += !check_ini("dump", NULL);
+	if (ini && tini_save_ini(ini, saved_path) == 0) {
+		ini_file* saved = tini_load_ini(saved_path);
+		failures += !check_ini("save", saved);
+		tini_free_ini(saved);
+	} else
+		failures += !check_ini("save", NULL);
+	tini_free_ini(ini);
+	
+	/* Arena */
+	ini = tini_load_ini_ex(path, TINI_FLAG_USE_ARENA);
+	failures += !check_ini("arena", ini);
+	tini_free_ini(ini);
+	
+	/* Buffer */
+	ini = tini_load_ini_from_buffer(text, length);
+	failures += !check_ini("buffer", ini);
+	tini_free_ini(ini);
+	
+	/* In place, object takes ownership of the buffer */
+	copy = malloc(length);
+	if (copy) {
+		memcpy(copy, text, length);
+		ini = tini_load_ini_from_buffer_in_place(copy, length);
+		failures += !check_ini("in place", ini);
+		tini_free_ini(ini);
+	} else
+		failures += !check_ini("in place", NULL);
+	
+	unlink(path);
+	unlink(saved_path);
+	for (i = 0; i < expected_count; ++i)
+		free(expected[i].value);
+	free(expected);
+	free(text);
+	printf("parameters %lu, bytes %lu\n", (unsigned long)expected_count, (unsigned long)length);
+	printf("%s\n", failures == 0 ? "ok" : "FAILED");
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
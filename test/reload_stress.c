@@ -0,0 +1,179 @@
+/*=======================================================================================
+
+TinyINI - small and simple open-source library for loading, saving and
+managing INI file data structures in the memory.
+
+TinyINI is distributed under following terms and conditions:
+
+Copyright (c) 2015-2016, Ivan Pizhenko.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ''AS IS''
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL BEN HOYT BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+SPECIAL NOTICE
+TinyINI library relies on the open-source INIH library
+(https://github.com/benhoyt/inih) for parsing text of INI file.
+Source code of INIH library and information about it, including
+licensing conditions, is included in the subfolder inih.
+
+=======================================================================================*/
+
+
+/* Multi-threaded stress test of reloadable INI file handles. Readers look up 
+ * parameters of acquired versions while writers publish and reload new ones, 
+ * and every version must stay consistent and alive until it is released. 
+ * Intended to be built with -fsanitize=thread or -fsanitize=address.
+ */
+
+#include "tini/tini.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define READER_COUNT 8
+#define WRITER_COUNT 2
+#define VERSIONS_PER_WRITER 500
+/* Writers reload the file once per this number of published versions */
+#define RELOAD_INTERVAL 50
+/* Readers re-register once per this number of reads, so that reader records are reused */
+#define REREGISTER_INTERVAL 1024
+
+typedef struct {
+	ini_handle* handle;
+	int id;
+	long reads;
+	long failures;
+} thread_state;
+
+static int stop;
+
+/* Each version has parameters v and w with the same value, and a value of the version 
+ * of any other writer. Reader seeing them differ has seen partially built or freed version.
+ */
+static void* reader_thread(void* arg) {
+	thread_state* state = (thread_state*)arg;
+	ini_handle_reader* reader = tini_register_reader(state->handle);
+	const ini_file* ini;
+	const char* v;
+	const char* w;
+
+	if (!reader) {
+		state->failures++;
+		return NULL;
+	}
+	while (!__atomic_load_n(&stop, __ATOMIC_RELAXED)) {
+		ini = tini_acquire_ini(reader);
+		v = tini_find_parameter(ini, "s", "v", NULL);
+		w = tini_find_parameter(ini, "s", "w", NULL);
+		if (!v || !w || strcmp(v, w) != 0)
+			state->failures++;
+		tini_release_ini(reader);
+		if (++state->reads % REREGISTER_INTERVAL == 0) {
+			tini_unregister_reader(reader);
+			reader = tini_register_reader(state->handle);
+			if (!reader) {
+				state->failures++;
+				return NULL;
+			}
+		}
+	}
+	tini_unregister_reader(reader);
+	return NULL;
+}
+
+static void* writer_thread(void* arg) {
+	thread_state* state = (thread_state*)arg;
+	char value[64];
+	ini_file* ini;
+	int i;
+
+	for (i = 0; i < VERSIONS_PER_WRITER; i++) {
+		ini = tini_create_ini();
+		sprintf(value, "%d-%d", state->id, i);
+		if (!ini || tini_add_parameter(ini, "s", "v", value, 1) != 0 
+			|| tini_add_parameter(ini, "s", "w", value, 1) != 0) {
+			tini_free_ini(ini);
+			state->failures++;
+			continue;
+		}
+		tini_publish_ini(state->handle, ini);
+		if (i % RELOAD_INTERVAL == 0 && tini_reload(state->handle, NULL) != 0)
+			state->failures++;
+	}
+	return NULL;
+}
+
+int main(void) {
+	char path[] = "/tmp/tini_reload_stress_XXXXXX";
+	static const char text[] = "[s]\nv=file\nw=file\n";
+	pthread_t threads[READER_COUNT + WRITER_COUNT];
+	thread_state states[READER_COUNT + WRITER_COUNT];
+	ini_handle* handle;
+	long reads = 0, failures = 0;
+	int fd, i;
+
+	fd = mkstemp(path);
+	if (fd < 0 || write(fd, text, sizeof(text) - 1) != (ssize_t)(sizeof(text) - 1)) {
+		perror("mkstemp");
+		return EXIT_FAILURE;
+	}
+	close(fd);
+	handle = tini_create_handle(path);
+	if (!handle) {
+		perror("tini_create_handle");
+		unlink(path);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < READER_COUNT + WRITER_COUNT; i++) {
+		states[i].handle = handle;
+		states[i].id = i;
+		states[i].reads = 0;
+		states[i].failures = 0;
+		if (pthread_create(&threads[i], NULL, i < READER_COUNT ? reader_thread : writer_thread, &states[i]) != 0) {
+			perror("pthread_create");
+			return EXIT_FAILURE;
+		}
+	}
+	for (i = READER_COUNT; i < READER_COUNT + WRITER_COUNT; i++)
+		pthread_join(threads[i], NULL);
+	__atomic_store_n(&stop, 1, __ATOMIC_RELAXED);
+	for (i = 0; i < READER_COUNT; i++)
+		pthread_join(threads[i], NULL);
+	for (i = 0; i < READER_COUNT + WRITER_COUNT; i++) {
+		reads += states[i].reads;
+		failures += states[i].failures;
+	}
+
+	/* Failed reload must keep the current version */
+	if (tini_reload(handle, "/nonexistent/tini_reload_stress.ini") == 0)
+		failures++;
+	tini_free_handle(handle);
+	unlink(path);
+
+	printf("readers %d, writers %d, reads %ld, failures %ld\n", READER_COUNT, WRITER_COUNT, reads, failures);
+	printf("%s\n", failures == 0 ? "ok" : "FAILED");
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
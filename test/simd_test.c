@@ -0,0 +1,280 @@
+/*=======================================================================================
+
+TinyINI - small and simple open-source library for loading, saving and
+managing INI file data structures in the memory.
+
+TinyINI is distributed under following terms and conditions:
+
+Copyright (c) 2015-2016, Ivan Pizhenko.
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of the copyright holder nor the names of its contributors
+      may be used to endorse or promote products derived from this software
+      without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ''AS IS''
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL BEN HOYT BE LIABLE FOR ANY
+DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+SPECIAL NOTICE
+TinyINI library relies on the open-source INIH library
+(https://github.com/benhoyt/inih) for parsing text of INI file.
+Source code of INIH library and information about it, including
+licensing conditions, is included in the subfolder inih.
+
+=======================================================================================*/
+
+
+/* Differential test of INIH line scanners. Vectorized lskip() and
+ * find_chars_or_comment() must return exactly the same pointers as scalar ones
+ * for strings at every alignment, and parser must produce byte-identical output
+ * with every scanner supported by CPU.
+ */
+
+/* Scanners and parser are static, so they are tested from the same translation unit */
+#include "../inih/ini.c"
+#include <stdlib.h>
+
+/* Strings are placed at every offset of a block, so that their starts and ends 
+ * fall at every position of vector loads.
+ */
+#define BLOCK_SIZE 64
+#define MAX_STRING_LENGTH 160
+#define STRING_ROUNDS 10000
+#define FILE_ROUNDS 2000
+
+/* Character sets searched by the parser: none for inline comments, section end and separators */
+#define CHAR_SET_COUNT 3
+#define MAX_FILE_LINES 40
+
+typedef struct {
+	const char* name;
+	const ini_scanner* scanner;
+} named_scanner;
+
+/* Output of the parser, each handler call is appended as section\0name\0value\n */
+typedef struct {
+	char* data;
+	size_t size;
+	size_t capacity;
+} output_buffer;
+
+static unsigned long long random_state = 0x9E3779B97F4A7C15ULL;
+
+static unsigned int next_random(void) {
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return (unsigned int)(random_state >> 32);
+}
+
+/* Bytes are biased toward whitespace and characters which stop the scans */
+static char random_char(void) {
+	static const char special[] = " \t\r\v\f;#=:[]";
+	unsigned int r = next_random() % 16;
+	if (r < 6)
+		return special[next_random() % (sizeof(special) - 1)];
+	if (r < 8)
+		return (char)(0x80 + next_random() % 0x80);
+	return (char)('a' + next_random() % 26);
+}
+
+static int collect_scanners(named_scanner* scanners) {
+	int count = 0;
+	scanners[count].name = "scalar";
+	scanners[count++].scanner = &scalar_scanner;
+#if INI_HAVE_SIMD
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2")) {
+		scanners[count].name = "sse2";
+		scanners[count++].scanner = &sse2_scanner;
+	}
+	if (__builtin_cpu_supports("avx2")) {
+		scanners[count].name = "avx2";
+		scanners[count++].scanner = &avx2_scanner;
+	}
+#endif
+	return count;
+}
+
+static int compare_scans(const named_scanner* scanners, int scanner_count) {
+	static char block[BLOCK_SIZE + MAX_STRING_LENGTH + 1] __attribute__((aligned(BLOCK_SIZE)));
+	static const char* const char_sets[CHAR_SET_COUNT] = { NULL, "]", "=:" };
+	size_t offset, length, i, j;
+	int round, k, failures = 0;
+	const char* s;
+	const char* expected;
+	const char* actual;
+	const char* expected_found[CHAR_SET_COUNT];
+	char saved;
+
+	for (round = 0; round < STRING_ROUNDS; round++) {
+		/* Fill the whole block, so that bytes after the null are not zeroes */
+		for (i = 0; i < sizeof(block); i++)
+			block[i] = random_char();
+		length = next_random() % (MAX_STRING_LENGTH + 1);
+		for (offset = 0; offset < BLOCK_SIZE; offset++) {
+			s = block + offset;
+			saved = block[offset + length];
+			block[offset + length] = '\0';
+			expected = scanners[0].scanner->lskip(s);
+			for (j = 0; j < CHAR_SET_COUNT; j++)
+				expected_found[j] = scanners[0].scanner->find_chars_or_comment(s, char_sets[j]);
+			for (k = 1; k < scanner_count; k++) {
+				actual = scanners[k].scanner->lskip(s);
+				if (actual != expected) {
+					fprintf(stderr, "%s lskip: offset %u, length %u: got %d, expected %d\n", scanners[k].name, 
+						(unsigned)offset, (unsigned)length, (int)(actual - s), (int)(expected - s));
+					failures++;
+				}
+				for (j = 0; j < CHAR_SET_COUNT; j++) {
+					actual = scanners[k].scanner->find_chars_or_comment(s, char_sets[j]);
+					if (actual != expected_found[j]) {
+						fprintf(stderr, "%s find_chars_or_comment(\"%s\"): offset %u, length %u: got %d, expected %d\n", 
+							scanners[k].name, char_sets[j] ? char_sets[j] : "", (unsigned)offset, (unsigned)length, 
+							(int)(actual - s), (int)(expected_found[j] - s));
+						failures++;
+					}
+				}
+			}
+			block[offset + length] = saved;
+			if (failures > 10)
+				return failures;
+		}
+	}
+	return failures;
+}
+
+static int append_output(output_buffer* out, const char* s) {
+	size_t length = strlen(s) + 1;
+	char* data;
+	if (out->size + length > out->capacity) {
+		out->capacity = (out->size + length) * 2;
+		data = (char*)realloc(out->data, out->capacity);
+		if (!data)
+			return 0;
+		out->data = data;
+	}
+	memcpy(out->data + out->size, s, length);
+	out->size += length;
+	return 1;
+}
+
+static int output_handler(void* user, const char* section, const char* name, const char* value) {
+	output_buffer* out = (output_buffer*)user;
+	return append_output(out, section) && append_output(out, name ? name : "\n") && append_output(out, value);
+}
+
+/* Same as ini_parse_buffer(), but with given scanner */
+static int parse_with_scanner(const ini_scanner* scanner, char* buffer, size_t length, output_buffer* out) {
+	char* line = buffer;
+	char* end = buffer + length;
+	char* eol;
+	ini_parser parser;
+
+	parser.scanner = scanner;
+	parser.handler = output_handler;
+	parser.user = out;
+	parser.section = end;
+	parser.prev_name = end;
+	parser.copy_names = 0;
+	parser.lineno = 0;
+	parser.error = 0;
+	*end = '\0';
+	while (line < end) {
+		eol = (char*)memchr(line, '\n', end - line);
+		if (!eol)
+			eol = end;
+		*eol = '\0';
+		parse_line(&parser, line);
+		line = eol + 1;
+	}
+	return parser.error;
+}
+
+/* Generate random INI file text made of sections, parameters, comments and continuation lines */
+static size_t generate_file(char* text) {
+	size_t size = 0, i;
+	unsigned int line_count = 1 + next_random() % MAX_FILE_LINES, line, length;
+	for (line = 0; line < line_count; line++) {
+		switch (next_random() % 5) {
+		case 0:
+			text[size++] = '[';
+			break;
+		case 1:
+			text[size++] = ' ';
+			break;
+		default:
+			break;
+		}
+		length = next_random() % MAX_STRING_LENGTH;
+		for (i = 0; i < length; i++) {
+			text[size] = random_char();
+			if (text[size] != '\0')
+				size++;
+		}
+		text[size++] = '\n';
+	}
+	return size;
+}
+
+static int compare_parsers(const named_scanner* scanners, int scanner_count) {
+	static char text[MAX_FILE_LINES * (MAX_STRING_LENGTH + 2)];
+	static char buffer[sizeof(text) + 1];
+	output_buffer expected = { NULL, 0, 0 }, actual = { NULL, 0, 0 };
+	int round, k, expected_error, actual_error, failures = 0;
+	size_t size;
+
+	for (round = 0; round < FILE_ROUNDS && failures < 10; round++) {
+		size = generate_file(text);
+		memcpy(buffer, text, size);
+		expected.size = 0;
+		expected_error = parse_with_scanner(scanners[0].scanner, buffer, size, &expected);
+		for (k = 1; k < scanner_count; k++) {
+			memcpy(buffer, text, size);
+			actual.size = 0;
+			actual_error = parse_with_scanner(scanners[k].scanner, buffer, size, &actual);
+			if (actual_error != expected_error || actual.size != expected.size 
+				|| memcmp(actual.data, expected.data, expected.size) != 0) {
+				fprintf(stderr, "%s parser: output differs on file %d\n", scanners[k].name, round);
+				failures++;
+			}
+		}
+	}
+	free(expected.data);
+	free(actual.data);
+	return failures;
+}
+
+int main(void) {
+	named_scanner scanners[3];
+	int scanner_count = collect_scanners(scanners);
+	int failures, k;
+
+	printf("scanners:");
+	for (k = 0; k < scanner_count; k++)
+		printf(" %s", scanners[k].name);
+	printf("\n");
+	if (scanner_count == 1) {
+		printf("no vectorized scanners to compare\n");
+		return 0;
+	}
+	failures = compare_scans(scanners, scanner_count);
+	failures += compare_parsers(scanners, scanner_count);
+	printf("%s\n", failures == 0 ? "ok" : "FAILED");
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -41,10 +41,64 @@ licensing conditions, is included in the subfolder inih.
 #include "include/tini/tini.h"
 #include <errno.h>
 #include <malloc.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include "inih/ini.h"
 
+#if defined(TINI_FEATURE_LOAD_INI_MMAP) || defined(TINI_FEATURE_BINARY_CACHE)
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(TINI_FEATURE_SAVE_INI) || defined(TINI_FEATURE_BINARY_CACHE)
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifdef TINI_FEATURE_RELOAD_INI
+#include <sched.h>
+#include <stdlib.h>
+#endif
+
+#ifdef TINI_FEATURE_PARALLEL_LOAD
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+#endif
+
+#ifdef TINI_FEATURE_LOAD_DIR
+#include <dirent.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef TINI_FEATURE_TYPED_VALUES
+#include <locale.h>
+#include <math.h>
+#include <stdlib.h>
+#endif
+
+#ifdef TINI_FEATURE_STATS
+#include <time.h>
+#endif
+
+#if defined(TINI_FEATURE_ALLOCATOR) && !INI_USE_STACK && !INI_CUSTOM_ALLOCATOR
+#error "TINI_FEATURE_ALLOCATOR requires INI_CUSTOM_ALLOCATOR=1 when INI_USE_STACK=0, so that INIH allocates through it"
+#endif
+
+#ifdef TINI_FEATURE_WATCH_INI
+#include <poll.h>
+#include <sys/inotify.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
 /* INI section data structure */
 struct _ini_section {
 	char* name; /* section name */
@@ -52,78 +106,750 @@ struct _ini_section {
 	char** values; /* array of parameter values */
 	size_t parameter_count; /* current number of parameters */
 	size_t max_parameter_count; /* maximum number of parameters for which memory is currently allocated */
+	size_t hash; /* hash of the section name */
+	uint32_t* key_index; /* open addressing hash table of parameter indexes + 1, NULL for small sections */
+	size_t key_index_size; /* number of slots in the parameter hash table, zero or power of two */
+	ini_file* owner; /* INI file object which owns this section, NULL for standalone sections */
+	uint64_t text_hash; /* hash of INI file text spans section was parsed from, zero if unknown or modified */
+	struct _ini_typed_value* typed_values; /* cache of converted parameter values, allocated on first use, or NULL */
+#ifdef TINI_FEATURE_EDIT_INI
+	size_t removed_parameter_count; /* number of tombstones left in parameter storage by removed parameters */
+	char** view; /* dense copy of keys followed by values while storage has tombstones, made on first use, or NULL */
+#endif
+};
+
+/* Parameter slots of small sections are stored inline, right after the section object, 
+ * followed by the section name, so that small section takes single memory block.
+ */
+#define SECTION_INLINE_SLOTS(section) ((char**)((section) + 1))
+#define SECTION_INLINE_SLOT_COUNT ((TINI_PARAMETER_INLINE_SIZE + 1) * 2)
+#define SECTION_INLINE_NAME(section) ((char*)(SECTION_INLINE_SLOTS(section) + SECTION_INLINE_SLOT_COUNT))
+#define SECTION_INLINE_SIZE (sizeof(ini_section) + sizeof(char*) * SECTION_INLINE_SLOT_COUNT)
+
+/* Kinds of converted parameter values */
+enum {
+	TYPED_INT64,
+	TYPED_DOUBLE,
+	TYPED_BOOL,
+	TYPED_DURATION,
+	TYPED_KIND_COUNT
+};
+
+/* State bits of the converted value: value of the given kind is cached, its conversion failed */
+#define TYPED_CACHED(kind) (1u << (kind))
+#define TYPED_FAILED(kind) (1u << ((kind) + TYPED_KIND_COUNT))
+
+/* Converted values of a parameter. Readers may convert concurrently, so all fields are 
+ * accessed atomically, and state bits are published after the value.
+ */
+struct _ini_typed_value {
+	uint64_t values[TYPED_KIND_COUNT]; /* converted values, or errno of failed conversions */
+	uint32_t state; /* TYPED_CACHED and TYPED_FAILED bits */
+};
+
+/* Memory arena chunk header, chunk data follows it */
+struct _ini_arena_chunk {
+	struct _ini_arena_chunk* next; /* next chunk in the list */
+	size_t size; /* size of chunk data */
+	size_t used; /* number of used bytes of chunk data */
 };
 
+/* Most strictly aligned types which are allocated from the memory arena */
+union _ini_arena_align {
+	void* p;
+	size_t s;
+	uint64_t u;
+	double d;
+};
+
+/* Alignment of objects allocated from the memory arena */
+#define ARENA_ALIGNMENT sizeof(union _ini_arena_align)
+
+/* Size of memory arena chunk header, rounded up to keep chunk data aligned */
+#define ARENA_CHUNK_HEADER_SIZE \
+	((sizeof(struct _ini_arena_chunk) + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1))
+
 struct _ini_file {
 	ini_section** sections; /* array of INI file sections */
 	size_t section_count; /* number  of sections */
 	size_t max_section_count; /* maximum number of parameters for which memory is currently allocated */
+	size_t* section_index; /* open addressing hash table of section indexes + 1, zero marks free slot */
+	size_t section_index_size; /* number of slots in the section hash table, zero or power of two */
+	unsigned int flags; /* TINI_FLAG_XXX flags given at creation */
+	struct _ini_arena_chunk* arena; /* memory arena chunks, current chunk first */
+	char* buffer; /* text buffer parsed in place, which strings point into, or NULL */
+	size_t buffer_size; /* size of the text buffer */
+	int buffer_mapped; /* nonzero if text buffer is memory mapped file, zero if it is allocated with malloc */
+	int borrow_strings; /* nonzero while parsing text buffer in place, strings are referenced instead of copied */
+	struct _ini_text_span* spans; /* INI file text spans found by the last incremental reload */
+	size_t span_count; /* number of INI file text spans */
+	char* span_text; /* INI file text of the last incremental reload, which spans point into */
+	uint64_t generation; /* unique number, changed whenever parameters may move or disappear */
+	ini_section* last_section; /* section of the parameter added last, which continuation lines are appended to, or NULL */
+	size_t last_parameter; /* index of the parameter added last */
+	size_t last_value_length; /* length of its value, valid if last_value_size is not zero */
+	size_t last_value_size; /* size of its value storage, zero until the first continuation line */
+#ifdef TINI_FEATURE_EDIT_INI
+	size_t removed_section_count; /* number of tombstones left in section storage by removed sections */
+	size_t removed_parameter_count; /* number of tombstones left in parameter storage of all sections */
+	ini_section** view; /* dense copy of sections while storage has tombstones, made on first use, or NULL */
+#endif
+#ifdef TINI_FEATURE_ALLOCATOR
+	ini_allocator allocator; /* allocator of all memory owned by this object */
+#endif
+#ifdef TINI_FEATURE_STATS
+	ini_stats stats; /* statistics counters */
+#endif
 };
 
-static size_t find_section_index(const ini_file* ini, const char* section) {
+#ifdef TINI_FEATURE_STATS
+
+/* Statistics of all INI file objects, including destroyed ones */
+static ini_stats global_stats;
+
+static void stats_add(const ini_file* ini, size_t offset, unsigned long long n) {
+	/* Counters are updated atomically, since lookups in the same object may run concurrently */
+	__atomic_fetch_add((unsigned long long*)((char*)&global_stats + offset), n, __ATOMIC_RELAXED);
+	if (ini)
+		__atomic_fetch_add((unsigned long long*)((char*)&((ini_file*)ini)->stats + offset), n, __ATOMIC_RELAXED);
+}
+
+static unsigned long long stats_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+/* Add to the counter of given INI file object, which may be NULL, and to the global counter */
+#define STATS_ADD(ini, field, n) stats_add((ini), offsetof(ini_stats, field), (unsigned long long)(n))
+
+/* Start timer, must be the last declaration in the block */
+#define STATS_TIMER(start) unsigned long long start = stats_now()
+
+/* Add time elapsed since timer start to the counter */
+#define STATS_ADD_TIME(ini, field, start) STATS_ADD(ini, field, stats_now() - (start))
+
+#else
+
+/* Statistics cost nothing when disabled */
+#define STATS_ADD(ini, field, n) ((void)(ini))
+#define STATS_TIMER(start)
+#define STATS_ADD_TIME(ini, field, start) ((void)0)
+
+#endif
+
+/* Initial value of 64-bit FNV-1a hash */
+#define HASH_BASIS 14695981039346656037ULL
+
+static uint64_t hash_bytes(uint64_t h, const char* s) {
+	/* Continue 64-bit FNV-1a hash with all characters of the given string, including terminating null */
+	do {
+		h ^= (unsigned char)*s;
+		h *= 1099511628211ULL;
+	} while (*s++);
+	return h;
+}
+
+static size_t hash_string(const char* s) {
+	/* 64-bit FNV-1a hash, folded to size_t on 32-bit platforms */
+	uint64_t h = hash_bytes(HASH_BASIS, s);
+	return (size_t)(h ^ (h >> 32));
+}
+
+#ifdef TINI_FEATURE_ALLOCATOR
+
+static void* default_allocate(void* context, size_t size) {
+	(void)context;
+	return malloc(size);
+}
+
+static void* default_reallocate(void* context, void* ptr, size_t size) {
+	(void)context;
+	return realloc(ptr, size);
+}
+
+static void default_deallocate(void* context, void* ptr) {
+	(void)context;
+	free(ptr);
+}
+
+/* Allocator of new INI file objects and of memory which isn't owned by any INI file object */
+static ini_allocator global_allocator = { &default_allocate, &default_reallocate, &default_deallocate, NULL };
+
+/* Allocator used for given INI file object, which may be NULL */
+#define GET_ALLOCATOR(ini) ((ini) ? &(ini)->allocator : &global_allocator)
+
+#endif
+
+static void* allocate(const ini_file* ini, size_t size) {
+	/* Allocate memory on behalf of given INI file object, which may be NULL */
+	STATS_ADD(ini, allocations, 1);
+	STATS_ADD(ini, allocated_bytes, size);
+#ifdef TINI_FEATURE_ALLOCATOR
+	{
+		const ini_allocator* allocator = GET_ALLOCATOR(ini);
+		return allocator->allocate(allocator->context, size);
+	}
+#else
+	return malloc(size);
+#endif
+}
+
+#if defined(TINI_FEATURE_TYPED_VALUES) || defined(TINI_FEATURE_OVERLAY) || defined(TINI_FEATURE_INCREMENTAL_RELOAD)
+
+static void* allocate_zeroed(const ini_file* ini, size_t size) {
+	void* ptr = allocate(ini, size);
+	return ptr ? memset(ptr, 0, size) : NULL;
+}
+
+#endif
+
+static void* reallocate(const ini_file* ini, void* ptr, size_t size) {
+	/* Resize memory block of given INI file object, which may be NULL */
+	STATS_ADD(ini, allocations, 1);
+	STATS_ADD(ini, allocated_bytes, size);
+#ifdef TINI_FEATURE_ALLOCATOR
+	{
+		const ini_allocator* allocator = GET_ALLOCATOR(ini);
+		return allocator->reallocate(allocator->context, ptr, size);
+	}
+#else
+	return realloc(ptr, size);
+#endif
+}
+
+static void deallocate(const ini_file* ini, void* ptr) {
+	/* Free memory block of given INI file object, which may be NULL */
+#ifdef TINI_FEATURE_ALLOCATOR
+	const ini_allocator* allocator = GET_ALLOCATOR(ini);
+	if (ptr)
+		allocator->deallocate(allocator->context, ptr);
+#else
+	(void)ini;
+	free(ptr);
+#endif
+}
+
+#if INI_CUSTOM_ALLOCATOR
+
+/* INI file object being parsed by INIH library in this thread, whose allocator 
+ * is used for INIH line buffer
+ */
+static __thread const ini_file* parsed_ini = NULL;
+
+void* ini_malloc(size_t size) {
+	return allocate(parsed_ini, size);
+}
+
+void ini_free(void* ptr) {
+	deallocate(parsed_ini, ptr);
+}
+
+void* ini_realloc(void* ptr, size_t size) {
+	return reallocate(parsed_ini, ptr, size);
+}
+
+#endif
+
+static void* arena_alloc(ini_file* ini, size_t size, size_t alignment) {
+	struct _ini_arena_chunk* chunk = ini->arena;
+	size_t offset;
+	
+	/* Try to fit object into the current chunk */
+	if (chunk) {
+		offset = (chunk->used + alignment - 1) & ~(alignment - 1);
+		if (offset + size <= chunk->size) {
+			chunk->used = offset + size;
+			return (char*)chunk + ARENA_CHUNK_HEADER_SIZE + offset;
+		}
+	}
+	
+	/* Allocate new chunk. Large objects get dedicated chunk which is linked 
+	 * after the current one, so that free space in the current chunk is not lost. 
+	 */
+	if (size > TINI_ARENA_CHUNK_SIZE / 4) {
+		chunk = allocate(ini, ARENA_CHUNK_HEADER_SIZE + size);
+		if (!chunk)
+			return NULL;
+		chunk->size = chunk->used = size;
+		if (ini->arena) {
+			chunk->next = ini->arena->next;
+			ini->arena->next = chunk;
+		} else {
+			chunk->next = NULL;
+			ini->arena = chunk;
+		}
+	} else {
+		chunk = allocate(ini, ARENA_CHUNK_HEADER_SIZE + TINI_ARENA_CHUNK_SIZE);
+		if (!chunk)
+			return NULL;
+		chunk->size = TINI_ARENA_CHUNK_SIZE;
+		chunk->used = size;
+		chunk->next = ini->arena;
+		ini->arena = chunk;
+	}
+	
+	return (char*)chunk + ARENA_CHUNK_HEADER_SIZE;
+}
+
+static void free_arena(ini_file* ini) {
+	/* Free all chunks */
+	struct _ini_arena_chunk* chunk = ini->arena;
+	while (chunk) {
+		struct _ini_arena_chunk* next = chunk->next;
+		deallocate(ini, chunk);
+		chunk = next;
+	}
+	ini->arena = NULL;
+}
+
+static int uses_arena(const ini_file* ini) {
+	return ini && (ini->flags & TINI_FLAG_USE_ARENA);
+}
+
+static char* duplicate_string(ini_file* owner, const char* s) {
+	size_t size;
+	char* copy;
+	
+	/* Strings parsed in place are referenced right in the text buffer owned by INI file object */
+	if (owner && owner->borrow_strings)
+		return (char*)s;
+	
+	/* Strings of INI file objects in arena mode are allocated from the arena */
+	size = strlen(s) + 1;
+	copy = uses_arena(owner) ? arena_alloc(owner, size, 1) : allocate(owner, size);
+	return copy ? memcpy(copy, s, size) : NULL;
+}
+
+static void free_string(ini_file* owner, char* s) {
+	/* Strings allocated from the arena are freed all at once with the arena */
+	if (!uses_arena(owner))
+		deallocate(owner, s);
+}
+
+static void free_section(ini_section* section);
+
+static uint64_t next_generation(void) {
+	/* Generations are unique across all INI file objects, so that parameter handles 
+	 * of one object are never mistaken for valid ones by another.
+	 */
+	static uint64_t last_generation = 0;
+	return __atomic_add_fetch(&last_generation, 1, __ATOMIC_RELAXED);
+}
+
+/* INI file text span: text from one section header line at the start of a line up to the next one */
+struct _ini_text_span {
+	const char* text; /* span text in the file text kept by INI file object */
+	size_t length; /* length of the span text */
+	uint64_t hash; /* hash of the span text */
+	char* names; /* names of sections which have parameters in the span, each followed by null */
+	size_t name_count; /* number of section names */
+};
+
+static void free_text_spans(const ini_file* ini, struct _ini_text_span* spans, size_t count) {
 	size_t i;
+	for (i = 0; i < count; ++i)
+		deallocate(ini, spans[i].names);
+	deallocate(ini, spans);
+}
+
+static size_t find_section_index_by_hash(const ini_file* ini, const char* section, size_t hash) {
+	size_t mask, i, j;
+	
+	/* Empty INI file object has no hash table yet */
+	if (ini->section_index_size == 0) {
+		STATS_ADD(ini, section_misses, 1);
+		return 0;
+	}
 	
-	/* Enumerate all sections, compare section name to the given input, 
+	/* Probe hash table starting from the home slot of the given hash, 
 	 * return section index + 1 if match found, otherwise return zero.
 	 */
+	mask = ini->section_index_size - 1;
+	for (i = hash & mask; (j = ini->section_index[i]) != 0; i = (i + 1) & mask) {
+		const ini_section* s = ini->sections[j - 1];
+		if (s && s->hash == hash && strcmp(s->name, section) == 0) {
+			STATS_ADD(ini, section_hits, 1);
+			STATS_ADD(ini, section_probes, ((i - hash) & mask) + 1);
+			return j;
+		}
+	}
+	
+	STATS_ADD(ini, section_misses, 1);
+	STATS_ADD(ini, section_probes, ((i - hash) & mask) + 1);
+	return 0;
+}
+
+static size_t find_section_index(const ini_file* ini, const char* section) {
+	return find_section_index_by_hash(ini, section, hash_string(section));
+}
+
+static void insert_section_index(ini_file* ini, size_t index) {
+	/* Put section index + 1 into the first free slot starting from the home slot */
+	size_t mask = ini->section_index_size - 1;
+	size_t i = ini->sections[index]->hash & mask;
+	while (ini->section_index[i] != 0)
+		i = (i + 1) & mask;
+	ini->section_index[i] = index + 1;
+}
+
+static int rebuild_section_index(ini_file* ini, size_t new_size) {
+	size_t i;
+	
+	/* Allocate new hash table, if size changes */
+	if (new_size != ini->section_index_size) {
+		size_t* new_index = allocate(ini, sizeof(size_t) * new_size);
+		if (!new_index)
+			return -1;
+		STATS_ADD(ini, grow_events, 1);
+		deallocate(ini, ini->section_index);
+		ini->section_index = new_index;
+		ini->section_index_size = new_size;
+	}
+	
+	/* Re-insert all sections, skipping tombstones of removed ones */
+	memset(ini->section_index, 0, sizeof(size_t) * ini->section_index_size);
 	for (i = 0; i < ini->section_count; ++i) {
-		if (strcmp(ini->sections[i]->name, section) == 0)
-			return i + 1;
+		if (ini->sections[i])
+			insert_section_index(ini, i);
 	}
 	
 	return 0;
 }
 
-static size_t find_parameter_index_in_section(const ini_section* section, const char* key) {
+static int reserve_section_index(ini_file* ini, size_t section_count) {
+	/* Keep load factor of the hash table at most 1/2 */
+	size_t new_size = ini->section_index_size ? ini->section_index_size : TINI_SECTION_INDEX_INITIAL_SIZE;
+	while (new_size < section_count * 2)
+		new_size *= 2;
+	return new_size == ini->section_index_size ? 0 : rebuild_section_index(ini, new_size);
+}
+
+static size_t find_parameter_index_by_hash(const ini_section* section, const char* key, size_t hash) {
 	size_t i;
+	
+	if (section->key_index) {
+		/* Probe hash table starting from the home slot of the key hash, 
+		 * return parameter index + 1 if match found, otherwise return zero.
+		 */
+		size_t mask = section->key_index_size - 1;
+		uint32_t j;
+		for (i = hash & mask; (j = section->key_index[i]) != 0; i = (i + 1) & mask) {
+			if (section->keys[j - 1] && strcmp(section->keys[j - 1], key) == 0) {
+				STATS_ADD(section->owner, parameter_hits, 1);
+				STATS_ADD(section->owner, parameter_probes, ((i - hash) & mask) + 1);
+				return j;
+			}
+		}
+		STATS_ADD(section->owner, parameter_probes, ((i - hash) & mask) + 1);
+	} else {
+		/* Small section - enumerate all parameter names, compare parameter name to the given input, 
+		 * return parameter index + 1 if match found, otherwise return zero.
+		 */
+		for (i = 0; i < section->parameter_count; ++i) {
+			if(section->keys[i] && strcmp(section->keys[i], key) == 0) {
+				STATS_ADD(section->owner, parameter_hits, 1);
+				STATS_ADD(section->owner, parameter_probes, i + 1);
+				return i + 1;
+			}
+		}
+		STATS_ADD(section->owner, parameter_probes, i);
+	}
 
-	/* Enumerate all parameter names, compare parameter name to the given input, 
-	 * return parameter index + 1 if match found, otherwise return zero.
-	 */
+	STATS_ADD(section->owner, parameter_misses, 1);
+	return 0;
+}
+
+static size_t find_parameter_index_in_section(const ini_section* section, const char* key) {
+	/* Small sections are scanned without hashing */
+	return find_parameter_index_by_hash(section, key, section->key_index ? hash_string(key) : 0);
+}
+
+static void insert_key_index(ini_section* section, size_t index) {
+	/* Put parameter index + 1 into the first free slot starting from the home slot */
+	size_t mask = section->key_index_size - 1;
+	size_t i = hash_string(section->keys[index]) & mask;
+	while (section->key_index[i] != 0)
+		i = (i + 1) & mask;
+	section->key_index[i] = (uint32_t)(index + 1);
+}
+
+static int rebuild_key_index(ini_section* section, size_t new_size) {
+	size_t i;
+	
+	/* Allocate new hash table, if size changes */
+	if (new_size != section->key_index_size) {
+		uint32_t* new_index = allocate(section->owner, sizeof(uint32_t) * new_size);
+		if (!new_index)
+			return -1;
+		STATS_ADD(section->owner, grow_events, 1);
+		deallocate(section->owner, section->key_index);
+		section->key_index = new_index;
+		section->key_index_size = new_size;
+	}
+	
+	/* Re-insert all parameters, skipping tombstones of removed ones */
+	memset(section->key_index, 0, sizeof(uint32_t) * section->key_index_size);
 	for (i = 0; i < section->parameter_count; ++i) {
-		if(strcmp(section->keys[i], key) == 0)
-			return i + 1;
+		if (section->keys[i])
+			insert_key_index(section, i);
 	}
+	
+	return 0;
+}
 
+static int reserve_key_index(ini_section* section, size_t parameter_count) {
+	size_t new_size;
+	
+	/* Small sections are searched linearly and need no hash table */
+	if (!section->key_index && parameter_count < TINI_PARAMETER_INDEX_THRESHOLD)
 		return 0;
+	
+	/* Keep load factor of the hash table at most 1/2 */
+	new_size = section->key_index_size ? section->key_index_size : TINI_PARAMETER_INDEX_THRESHOLD;
+	while (new_size < parameter_count * 2)
+		new_size *= 2;
+	return new_size == section->key_index_size ? 0 : rebuild_key_index(section, new_size);
 }
 
-#ifdef TINI_FEATURE_EDIT_INI_FILE
+#ifdef TINI_FEATURE_EDIT_INI
+
+/* Removed sections and parameters leave NULL tombstones in their storage, so that removal 
+ * doesn't move other items and takes constant time. Lookups and enumeration skip tombstones, 
+ * which never modifies the object. Storage is compacted only by writers: when tombstones take 
+ * over half of it, when storage is full and new item is added, on reload, and by tini_compact().
+ * Storage views are kept dense by dense copies of storage with tombstones, which readers make 
+ * on first use, and writers drop whenever storage changes.
+ */
 
-static void remove_section_by_index(ini_file* ini, size_t index) {
-	/* Destroy section object */
-	tini_free_section(ini->sections[index]);
+static void drop_parameter_view(ini_section* section) {
+	deallocate(section->owner, section->view);
+	section->view = NULL;
+}
+
+static void drop_section_view(ini_file* ini) {
+	deallocate(ini, ini->view);
+	ini->view = NULL;
+}
+
+static void compact_sections(ini_file* ini) {
+	size_t i, j;
+	
+	/* Nothing to do without tombstones */
+	if (ini->removed_section_count == 0)
+		return;
+	
+	/* Move remaining sections over tombstones, keeping their order */
+	for (i = j = 0; i < ini->section_count; ++i) {
+		if (ini->sections[i])
+			ini->sections[j++] = ini->sections[i];
+	}
+	ini->section_count = j;
+	ini->removed_section_count = 0;
+	drop_section_view(ini);
 	
-	/* Pack array of section pointers if removed section was in the beginning or middle */
-	if(index < ini->section_count - 1) {
-		memmove(ini->sections + index, ini->sections + index + 1, 
-			sizeof(ini_section*) * (ini->section_count - index - 1));
+	/* Section indexes have been shifted, so re-insert them into the hash table, 
+	 * which keeps its size and can't fail, and invalidate parameter handles
+	 */
+	if (ini->section_index_size)
+		rebuild_section_index(ini, ini->section_index_size);
+	ini->generation = next_generation();
+}
+
+static void compact_section(ini_section* section) {
+	size_t i, j;
+	
+	/* Nothing to do without tombstones */
+	if (section->removed_parameter_count == 0)
+		return;
+	
+	/* Move remaining parameters over tombstones, keeping their order and terminating nulls */
+	for (i = j = 0; i < section->parameter_count; ++i) {
+		if (section->keys[i]) {
+			section->keys[j] = section->keys[i];
+			section->values[j] = section->values[i];
+			++j;
+		}
 	}
+	section->keys[j] = NULL;
+	section->values[j] = NULL;
+	section->parameter_count = j;
+	section->owner->removed_parameter_count -= section->removed_parameter_count;
+	section->removed_parameter_count = 0;
+	drop_parameter_view(section);
+	
+	/* Parameter indexes have been shifted, so re-insert them into the hash table, 
+	 * drop converted values and invalidate parameter handles
+	 */
+	if (section->key_index)
+		rebuild_key_index(section, section->key_index_size);
+	deallocate(section->owner, section->typed_values);
+	section->typed_values = NULL;
+	section->owner->generation = next_generation();
+}
+
+static void compact_ini(ini_file* ini) {
+	size_t i;
+	
+	/* Compact section storage first, then parameter storage of sections with tombstones */
+	compact_sections(ini);
+	for (i = 0; i < ini->section_count && ini->removed_parameter_count != 0; ++i)
+		compact_section(ini->sections[i]);
+}
+
+static void remove_section_by_index(ini_file* ini, size_t index) {
+	/* Destroy section object along with its parameter tombstones, invalidating parameter handles */
+	ini_section* section = ini->sections[index];
+	ini->removed_parameter_count -= section->removed_parameter_count;
+	free_section(section);
+	ini->generation = next_generation();
 	
-	/* Decrease current number of sections */
-	--ini->section_count;	
+	/* Leave tombstone in place of the section */
+	ini->sections[index] = NULL;
+	++ini->removed_section_count;
+	drop_section_view(ini);
+	
+	/* Compact storage once it is mostly tombstones, so that removal takes amortized constant time */
+	if (ini->removed_section_count * 2 > ini->section_count)
+		compact_sections(ini);
+}
+
+static void remove_parameter_by_index(ini_section* section, size_t index) {
+	ini_file* ini = section->owner;
+	
+	/* Free parameter name and value strings, invalidate parameter handles */
+	free_string(ini, section->values[index]);
+	free_string(ini, section->keys[index]);
+	ini->generation = next_generation();
+	
+	/* Section no longer matches INI file text it was parsed from */
+	section->text_hash = 0;
+	
+	/* Leave tombstone in place of the parameter */
+	section->keys[index] = NULL;
+	section->values[index] = NULL;
+	++section->removed_parameter_count;
+	++ini->removed_parameter_count;
+	drop_parameter_view(section);
+	
+	/* Compact storage once it is mostly tombstones, so that removal takes amortized constant time */
+	if (section->removed_parameter_count * 2 > section->parameter_count)
+		compact_section(section);
 }
 
+/* Compact storage of given INI file object before it is rebuilt by writer */
+#define COMPACT_INI(ini) compact_ini(ini)
+
+/* Number of parameters in the section storage, not counting tombstones */
+#define LIVE_PARAMETER_COUNT(section) ((section)->parameter_count - (section)->removed_parameter_count)
+
+/* Drop dense copies of storage which is about to change */
+#define DROP_PARAMETER_VIEW(section) drop_parameter_view(section)
+#define DROP_SECTION_VIEW(ini) drop_section_view(ini)
+
+#else
+
+#define COMPACT_INI(ini) ((void)0)
+#define LIVE_PARAMETER_COUNT(section) ((section)->parameter_count)
+#define DROP_PARAMETER_VIEW(section) ((void)0)
+#define DROP_SECTION_VIEW(ini) ((void)0)
+
 #endif
 
+static size_t grow_storage_size(size_t size, size_t min_size, size_t min_increment) {
+	/* Grow storage geometrically, so that appending elements one by one takes amortized constant time */
+	while (size < min_size)
+		size += size > min_increment ? size : min_increment;
+	return size;
+}
+
+static int append_parameter_value(ini_file* ini, const char* line) {
+	ini_section* section = ini->last_section;
+	size_t length, new_length, new_size;
+	char* value;
+	char* new_value;
+	
+	/* Continuation line must follow parameter added successfully */
+	if (!section) {
+		errno = EINVAL;
+		return -1;
+	}
+	value = section->values[ini->last_parameter];
+	if (ini->last_value_size == 0)
+		ini->last_value_length = strlen(value);
+	length = strlen(line);
+	new_length = ini->last_value_length + 1 + length;
+	
+	if (ini->borrow_strings) {
+		/* Value parsed in place is followed by the continuation line in the text buffer, 
+		 * with text between them already parsed, so the line is moved right after the value
+		 */
+		new_value = value;
+		new_size = new_length + 1;
+	} else if (new_length + 1 <= ini->last_value_size) {
+		/* Line fits into the value storage */
+		new_value = value;
+		new_size = ini->last_value_size;
+	} else {
+		/* Grow value storage geometrically, so that N-line value is built in linear time */
+		new_size = grow_storage_size(ini->last_value_size, new_length + 1, TINI_MULTILINE_VALUE_SIZE_INCREMENT);
+		if (uses_arena(ini)) {
+			new_value = arena_alloc(ini, new_size, 1);
+			if (new_value)
+				memcpy(new_value, value, ini->last_value_length);
+		} else
+			new_value = reallocate(ini, value, new_size);
+		if (!new_value)
+			return -1;
+		STATS_ADD(ini, grow_events, 1);
+	}
+	
+	/* Lines are joined with newline, as in Python configparser */
+	new_value[ini->last_value_length] = '\n';
+	memmove(new_value + ini->last_value_length + 1, line, length + 1);
+	section->values[ini->last_parameter] = new_value;
+	if (section->typed_values)
+		section->typed_values[ini->last_parameter].state = 0;
+	DROP_PARAMETER_VIEW(section);
+	ini->last_value_length = new_length;
+	ini->last_value_size = new_size;
+	return 0;
+}
+
 /* INI file parsing handler for included INIH library. */
 static int ini_file_handler(void* user, const char* section, const char* name, 
 			    const char* value)
 {
+	ini_file* ini = user;
+	
+	/* Append continuation line of multi-line value to the parameter added last */
+	if (!name)
+		return append_parameter_value(ini, value) == 0 ? 1 : 0;
+	
 	/* Attempt to parameter to the INI file object, replace duplicates */
-	return tini_add_parameter((ini_file*)user, section, name, value, 1) == 0 
+	ini->last_section = NULL;
+	return tini_add_parameter(ini, section, name, value, 1) == 0 
 		? 1 : 0;
 }
 
-static int grow_section_storage(ini_file* ini) {
+static int reserve_section_storage(ini_file* ini, size_t section_count) {
+	size_t new_max_section_count;
+	ini_section** new_sections;
+	
+	/* Nothing to do if storage is large enough */
+	if (section_count <= ini->max_section_count)
+		return 0;
+	
 	/* Find new storage size */
-	size_t new_max_section_count = ini->max_section_count + TINI_SECTION_STORAGE_SIZE_INCREMENT;
+	new_max_section_count = grow_storage_size(ini->max_section_count, section_count, 
+		TINI_SECTION_STORAGE_SIZE_INCREMENT);
 	
 	/* Reallocate memory */
-	ini_section** new_sections = realloc(ini->sections, sizeof(ini_section*) * new_max_section_count);
+	new_sections = reallocate(ini, ini->sections, sizeof(ini_section*) * new_max_section_count);
 	
 	/* Update INI file object or indicate failure */
 	if (new_sections) {
+		STATS_ADD(ini, grow_events, 1);
 		ini->sections = new_sections;
 		ini->max_section_count = new_max_section_count;
 		return 0;
@@ -131,12 +857,32 @@ static int grow_section_storage(ini_file* ini) {
 	else return -1;	
 }
 
-static int grow_parameter_storage(ini_section* section) {
+static int reserve_parameter_storage(ini_section* section, size_t parameter_count) {
+	size_t new_max_parameter_count;
+	char** new_keys;
+	
+	/* Nothing to do if storage is large enough */
+	if (parameter_count <= section->max_parameter_count)
+		return 0;
+	
 	/* Find new storage size */
-	size_t new_max_parameter_count = section->max_parameter_count + TINI_PARAMETER_STORAGE_SIZE_INCREMENT;
-
-	/* Reallocate memory */
-	char** new_keys = realloc(section->keys, sizeof(char*) * (new_max_parameter_count + 1) * 2);
+	new_max_parameter_count = grow_storage_size(section->max_parameter_count, parameter_count, 
+		TINI_PARAMETER_STORAGE_SIZE_INCREMENT);
+	
+	if (section->keys == SECTION_INLINE_SLOTS(section)) {
+		/* Move parameters out of the inline storage */
+		if (new_max_parameter_count < TINI_PARAMETER_STORAGE_INITIAL_SIZE)
+			new_max_parameter_count = TINI_PARAMETER_STORAGE_INITIAL_SIZE;
+		new_keys = allocate(section->owner, sizeof(char*) * (new_max_parameter_count + 1) * 2);
+		if (new_keys) {
+			memcpy(new_keys, section->keys, sizeof(char*) * (section->parameter_count + 1));
+			memcpy(new_keys + section->max_parameter_count + 1, section->values, 
+				sizeof(char*) * (section->parameter_count + 1));
+		}
+	} else {
+		/* Reallocate memory */
+		new_keys = reallocate(section->owner, section->keys, sizeof(char*) * (new_max_parameter_count + 1) * 2);
+	}
 
 	/* Update INI file section object or indicate failure */
 	if (new_keys) {
@@ -146,98 +892,155 @@ static int grow_parameter_storage(ini_section* section) {
 		section->keys = new_keys;
 		section->values = new_values;
 		section->max_parameter_count = new_max_parameter_count;
+		STATS_ADD(section->owner, grow_events, 1);
+		
+		/* Converted values cache is sized by storage, drop it */
+		deallocate(section->owner, section->typed_values);
+		section->typed_values = NULL;
 		return 0;
 	}
 	else return -1;	
 }
 
 static void cleanup_section(ini_section* section) {
-	/* Free memory consumed by parameter names and values */
-	size_t i;
-	for (i = 0; i < section->parameter_count; ++i) {
-		free(section->values[i]);
-		free(section->keys[i]);
+	/* Free memory consumed by parameter names and values, unless they live in the arena */
+	if (!uses_arena(section->owner)) {
+		size_t i;
+		for (i = 0; i < section->parameter_count; ++i) {
+			deallocate(section->owner, section->values[i]);
+			deallocate(section->owner, section->keys[i]);
+		}
+		
+		/* Free memory consumed by section name, unless it is inline */
+		if (section->name != SECTION_INLINE_NAME(section))
+			deallocate(section->owner, section->name);
 	}
 	
-	/* Free memory consumed by parameter names and values storage */
-	free(section->keys);
-
-	/* Free memory consumed by section name */
-	free(section->name);
+	/* Free memory consumed by parameter names and values storage, unless it is inline, 
+	 * hash table and converted values
+	 */
+	if (section->keys != SECTION_INLINE_SLOTS(section))
+		deallocate(section->owner, section->keys);
+	deallocate(section->owner, section->key_index);
+	deallocate(section->owner, section->typed_values);
+#ifdef TINI_FEATURE_EDIT_INI
+	deallocate(section->owner, section->view);
+#endif
 }
 
-static int initialize_section(ini_section* section, const char* name) {
-	/* Save previous errno */
-	int saved_errno = errno;
-
-	/* Create section name*/
-	section->name = strdup(name);
-	if (!section->name) {
-		saved_errno = errno;
-		goto exit_error;
-	}
+static void initialize_section(ini_section* section, ini_file* owner, const char* name, size_t name_size) {
+	/* Copy section name into inline storage, unless it is referenced in the text buffer */
+	section->owner = owner;
+	section->name = name_size ? memcpy(SECTION_INLINE_NAME(section), name, name_size) : (char*)name;
+	section->hash = hash_string(name);
 	
-	/* Allocate initial storage for parameter names and values */
-	section->keys = malloc(sizeof(const char*) * (TINI_PARAMETER_STORAGE_INITIAL_SIZE + 1) * 2);
-	if (!section->keys) {
-		saved_errno = errno;
-		goto cleanup_name;
-	}
-
-	/* Initialize storage */
-	section->values = section->keys + TINI_PARAMETER_STORAGE_INITIAL_SIZE + 1;
+	/* Initialize inline storage for parameter names and values */
+	section->keys = SECTION_INLINE_SLOTS(section);
+	section->values = section->keys + TINI_PARAMETER_INLINE_SIZE + 1;
 	*(section->keys) = NULL;
 	*(section->values) = NULL;
 	
 	/* Initialize counts of parameters */
 	section->parameter_count = 0;
-	section->max_parameter_count = TINI_PARAMETER_STORAGE_INITIAL_SIZE;
+	section->max_parameter_count = TINI_PARAMETER_INLINE_SIZE;
 	
-	return 0;
+	/* Hash table is created once section grows large enough */
+	section->key_index = NULL;
+	section->key_index_size = 0;
 	
-cleanup_name:
-	/* Free memory on error */
-	free(section->name);
+	/* Section isn't parsed from INI file text yet */
+	section->text_hash = 0;
 	
-exit_error:
-	/* restore saved errno */
-	errno = saved_errno;
-	return -1;
+	/* Converted values are cached on first use */
+	section->typed_values = NULL;
+	
+#ifdef TINI_FEATURE_EDIT_INI
+	/* No parameters have been removed yet */
+	section->removed_parameter_count = 0;
+	section->view = NULL;
+#endif
 }
 
 static int initialize_ini(ini_file* ini) {
 	/* Allocate storage for sections */
-	ini->sections = malloc(sizeof(ini_section*) * TINI_SECTION_STORAGE_INITIAL_SIZE);
+	ini->sections = allocate(ini, sizeof(ini_section*) * TINI_SECTION_STORAGE_INITIAL_SIZE);
 	
 	/* Initialize storage of sections or indicate error */
 	if (ini->sections) {
 		ini->section_count = 0;
 		ini->max_section_count = TINI_SECTION_STORAGE_INITIAL_SIZE;
+		ini->section_index = NULL;
+		ini->section_index_size = 0;
 		return 0;
 	}
 	else return -1;
 }
 
 static void cleanup_ini(ini_file* ini) {
-	/* Cleanup all section objects */
+	/* Cleanup all section objects, skipping tombstones of removed ones */
 	size_t i;
 	for (i = 0; i < ini->section_count; ++i) {
-		cleanup_section(ini->sections[i]);
-		free(ini->sections[i]);
+		if (ini->sections[i])
+			free_section(ini->sections[i]);
 	}
 	
-	/* Free sections storage */
-	free(ini->sections);
+	/* Free sections storage and hash table */
+	deallocate(ini, ini->sections);
+	deallocate(ini, ini->section_index);
+#ifdef TINI_FEATURE_EDIT_INI
+	deallocate(ini, ini->view);
+#endif
+	
+	/* Free INI file text spans and text they point into */
+	free_text_spans(ini, ini->spans, ini->span_count);
+	deallocate(NULL, ini->span_text);
+	
+	/* Free memory arena */
+	free_arena(ini);
+	
+	/* Free text buffer which strings point into */
+	if (ini->buffer) {
+#ifdef TINI_FEATURE_LOAD_INI_MMAP
+		if (ini->buffer_mapped)
+			munmap(ini->buffer, ini->buffer_size);
+		else
+#endif
+		deallocate(ini, ini->buffer);
+	}
 }
 
 ini_file* tini_create_ini(void) {
-	/* Allocate memory for INI file object */
-	ini_file* ini = malloc(sizeof(ini_file));
-	
-	/* Initialize object, check result, indicate error if necessary */
+	return tini_create_ini_ex(0);
+}
+
+static ini_file* setup_ini(ini_file* ini, unsigned int flags) {
+	/* Initialize newly allocated object, check result, indicate error if necessary */
+	if (ini) {
+#ifdef TINI_FEATURE_STATS
+		memset(&ini->stats, 0, sizeof(ini_stats));
+		ini->stats.allocations = 1;
+		ini->stats.allocated_bytes = sizeof(ini_file);
+#endif
+		ini->flags = flags;
+		ini->arena = NULL;
+		ini->buffer = NULL;
+		ini->buffer_size = 0;
+		ini->buffer_mapped = 0;
+		ini->borrow_strings = 0;
+		ini->spans = NULL;
+		ini->span_count = 0;
+		ini->span_text = NULL;
+		ini->generation = next_generation();
+		ini->last_section = NULL;
+#ifdef TINI_FEATURE_EDIT_INI
+		ini->removed_section_count = 0;
+		ini->removed_parameter_count = 0;
+		ini->view = NULL;
+#endif
+	}
 	if (ini && initialize_ini(ini) != 0) {
 		int saved_errno = errno;
-		free(ini);
+		deallocate(ini, ini);
 		ini = NULL;
 		errno = saved_errno;
 	}
@@ -246,28 +1049,106 @@ ini_file* tini_create_ini(void) {
 	return ini;
 }
 
+ini_file* tini_create_ini_ex(unsigned int flags) {
+	/* Allocate memory for INI file object */
+	ini_file* ini = allocate(NULL, sizeof(ini_file));
+#ifdef TINI_FEATURE_ALLOCATOR
+	if (ini)
+		ini->allocator = global_allocator;
+#endif
+	return setup_ini(ini, flags);
+}
+
+#ifdef TINI_FEATURE_ALLOCATOR
+
+static int check_allocator(const ini_allocator* allocator) {
+	if (!allocator->allocate || !allocator->reallocate || !allocator->deallocate) {
+		errno = EINVAL;
+		return -1;
+	}
+	return 0;
+}
+
+ini_file* tini_create_ini_with_allocator(unsigned int flags, const ini_allocator* allocator) {
+	ini_file* ini;
+	if (!allocator)
+		return tini_create_ini_ex(flags);
+	if (check_allocator(allocator) != 0)
+		return NULL;
+	
+	/* Allocate memory for INI file object with the given allocator, which it keeps */
+	STATS_ADD(NULL, allocations, 1);
+	STATS_ADD(NULL, allocated_bytes, sizeof(ini_file));
+	ini = allocator->allocate(allocator->context, sizeof(ini_file));
+	if (ini)
+		ini->allocator = *allocator;
+	return setup_ini(ini, flags);
+}
+
+int tini_set_allocator(const ini_allocator* allocator) {
+	static const ini_allocator default_allocator = { &default_allocate, &default_reallocate, &default_deallocate, NULL };
+	if (allocator && check_allocator(allocator) != 0)
+		return -1;
+	global_allocator = allocator ? *allocator : default_allocator;
+	return 0;
+}
+
+#endif
+
 void tini_free_ini(ini_file* ini) {
 	/* By convention, free()-like functions accept NULL input */
 	if (ini) {
+		/* Time of freeing is counted only globally, since object goes away */
+		STATS_TIMER(start);
+		
 		/* Cleanup object */
 		cleanup_ini(ini);
 		
 		/* free memory */
-		free(ini);
+		deallocate(ini, ini);
+		STATS_ADD_TIME(NULL, free_ns, start);
 	}
 }
 
 ini_file* tini_load_ini(const char* file_path) {
-	/* Create INI file object */
-	ini_file* ini = tini_create_ini();
-	
+	return tini_load_ini_ex(file_path, 0);
+}
+
+static ini_file* load_ini_file(ini_file* ini, const char* file_path) {
+	/* Parse file into the newly created INI file object, which is destroyed on failure */
 	if (ini) {
-		/* Parse INI file using INIH library into INI file object, check result, 
-		 * indicate error if necessary.
-		 */
-		if (ini_parse(file_path, &ini_file_handler, ini) < 0) {
+		/* Open file */
+		int res = -1;
+		FILE* f = fopen(file_path, "r");
+		if (f) {
+			/* Pre-size sections storage by file size, when it is known. File is read as stream, 
+			 * so section headers can't be counted in advance, and the estimate is capped.
+			 */
+			long size;
+			if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) > 0 && fseek(f, 0, SEEK_SET) == 0) {
+				size_t hint = (size_t)size / TINI_LOAD_HINT_BYTES_PER_SECTION + 1;
+				tini_reserve_sections(ini, hint < TINI_LOAD_HINT_MAX_SECTIONS ? hint : TINI_LOAD_HINT_MAX_SECTIONS);
+			}
+			
+			/* Parse INI file using INIH library into INI file object */
+			{
+				STATS_TIMER(start);
+#if INI_CUSTOM_ALLOCATOR
+				parsed_ini = ini;
+#endif
+				res = ini_parse_file(f, &ini_file_handler, ini);
+#if INI_CUSTOM_ALLOCATOR
+				parsed_ini = NULL;
+#endif
+				STATS_ADD_TIME(ini, parse_ns, start);
+			}
+			fclose(f);
+		}
+		
+		/* Check result, indicate error if necessary */
+		if (res < 0) {
 			int saved_errno = errno;
-			free(ini);
+			tini_free_ini(ini);
 			ini = NULL;
 			errno = saved_errno;
 		}
@@ -277,49 +1158,414 @@ ini_file* tini_load_ini(const char* file_path) {
 	return ini;
 }
 
-#ifdef TINI_FEATURE_SAVE_INI
+ini_file* tini_load_ini_ex(const char* file_path, unsigned int flags) {
+	return load_ini_file(tini_create_ini_ex(flags), file_path);
+}
 
-int tini_save_ini(const ini_file* ini, const char* file_path) {
-	/* Initialize result variable */
-	int res = -1;
+#ifdef TINI_FEATURE_ALLOCATOR
+
+ini_file* tini_load_ini_with_allocator(const char* file_path, unsigned int flags, const ini_allocator* allocator) {
+	return load_ini_file(tini_create_ini_with_allocator(flags, allocator), file_path);
+}
+
+#endif
+
+static size_t count_section_headers(const char* text, size_t length) {
+	/* Count lines which start with '[', this is an upper bound of the number of sections */
+	const char* end = text + length;
+	size_t count = 0;
+	while (text < end) {
+		const char* eol;
+		if (*text == '[')
+			++count;
+		eol = memchr(text, '\n', end - text);
+		if (!eol)
+			break;
+		text = eol + 1;
+	}
+	return count;
+}
+
+#if defined(TINI_FEATURE_INCREMENTAL_RELOAD) || defined(TINI_FEATURE_PARALLEL_LOAD)
+
+static int is_section_header_line(const char* line, const char* end) {
+	/* Check whether line starting with '[' is a valid section header, 
+	 * using the same rules as INIH parser does.
+	 */
+	const char* p;
+	for (p = line + 1; p < end && *p != '\n' && *p != '\0'; ++p) {
+		if (*p == ']')
+			return 1;
+#if INI_ALLOW_INLINE_COMMENTS
+		if (strchr(INI_INLINE_COMMENT_PREFIXES, *p) && (p[-1] == ' ' || (p[-1] >= '\t' && p[-1] <= '\r')))
+			return 0;
+#endif
+	}
+	return 0;
+}
+
+static char* read_text_file(ini_file* owner, const char* file_path, size_t* length) {
+	/* Read whole file into the buffer, allocated from the arena of given INI file object, 
+	 * where it is released along with the object, or on the heap if object is NULL
+	 */
+	char* text = NULL;
+	long size;
+	FILE* f = fopen(file_path, "rb");
+	if (!f)
+		return NULL;
+	if (fseek(f, 0, SEEK_END) == 0 && (size = ftell(f)) >= 0 && fseek(f, 0, SEEK_SET) == 0) {
+		text = owner ? arena_alloc(owner, (size_t)size + 1, 1) : allocate(NULL, (size_t)size + 1);
+		if (text && fread(text, 1, (size_t)size, f) != (size_t)size) {
+			if (!owner)
+				deallocate(NULL, text);
+			text = NULL;
+			errno = EIO;
+		}
+		*length = (size_t)size;
+	}
+	fclose(f);
+	return text;
+}
+
+#endif
+
+static int parse_in_place(ini_file* ini, char* buffer, size_t length) {
+	int res;
+	STATS_TIMER(start);
 	
-	/* Open file */
-	FILE* f = fopen(file_path, "w");
-	if (f) {
-		/* Dump INI file object into that file */
-		int saved_errno;
-		res = tini_dump_ini(ini, f);
-		
-		/* Close file */
-		saved_errno = errno;
-		if(fclose(f) != 0);
-			res = -1;
-		else
+	/* Pre-size sections storage, allowing for parameters before the first section header */
+	tini_reserve_sections(ini, count_section_headers(buffer, length) + 1);
+	
+	/* Parse text using INIH library, referencing all strings in the buffer. 
+	 * Buffer must be owned by INI file object, which must use memory arena. 
+	 * Returns number of the first line with error, or zero.
+	 */
+	ini->borrow_strings = 1;
+	res = ini_parse_buffer(buffer, length, &ini_file_handler, ini);
+	ini->borrow_strings = 0;
+	STATS_ADD_TIME(ini, parse_ns, start);
+	return res;
+}
+
+ini_file* tini_load_ini_from_buffer(const char* data, size_t length) {
+	/* Copy text into the buffer with room for terminating null */
+	char* buffer = allocate(NULL, length + 1);
+	if (!buffer)
+		return NULL;
+	memcpy(buffer, data, length);
+	
+	/* Parse the copy in place */
+	return tini_load_ini_from_buffer_in_place(buffer, length);
+}
+
+ini_file* tini_load_ini_from_buffer_in_place(char* data, size_t length) {
+	size_t parse_length;
+	int saved_errno;
+	
+	/* Create INI file object, its strings will live in the arena and in the buffer */
+	ini_file* ini = tini_create_ini_ex(TINI_FLAG_USE_ARENA);
+	if (!ini)
+		goto free_buffer;
+	
+	/* Find room for terminating null: last newline can be replaced with it, 
+	 * otherwise buffer is extended by one byte.
+	 */
+	if (length > 0 && data[length - 1] == '\n')
+		parse_length = length - 1;
+	else {
+		char* new_data = reallocate(ini, data, length + 1);
+		if (!new_data)
+			goto free_ini;
+		data = new_data;
+		parse_length = length;
+	}
+	ini->buffer = data;
+	ini->buffer_size = length;
+	
+	/* Parse buffer contents */
+	parse_in_place(ini, data, parse_length);
+	return ini;
+	
+free_ini:
+	/* Free memory on error */
+	saved_errno = errno;
+	tini_free_ini(ini);
+	errno = saved_errno;
+	
+free_buffer:
+	/* Buffer is owned by this function even on failure */
+	saved_errno = errno;
+	deallocate(NULL, data);
+	errno = saved_errno;
+	return NULL;
+}
+
+#ifdef TINI_FEATURE_LOAD_INI_MMAP
+
+static char* read_file(int fd, size_t size) {
+	/* Allocate buffer with room for terminating null */
+	char* buffer = allocate(NULL, size + 1);
+	size_t offset = 0;
+	if (!buffer)
+		return NULL;
+	
+	/* Read whole file, retry on interrupts and partial reads */
+	while (offset < size) {
+		ssize_t n = read(fd, buffer + offset, size - offset);
+		if (n > 0)
+			offset += (size_t)n;
+		else if (n == 0 || errno != EINTR) {
+			int saved_errno = n == 0 ? EIO : errno;
+			deallocate(NULL, buffer);
 			errno = saved_errno;
+			return NULL;
+		}
 	}
 	
-	/* Return result */
-	return res;
+	return buffer;
+}
+
+ini_file* tini_load_ini_mmap(const char* file_path) {
+	ini_file* ini = NULL;
+	struct stat st;
+	size_t length;
+	int saved_errno;
+	
+	/* Open file and find its size */
+	int fd = open(file_path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) != 0)
+		goto close_file;
+	
+	/* Create INI file object, its strings will live in the arena and in the file mapping */
+	ini = tini_create_ini_ex(TINI_FLAG_USE_ARENA);
+	if (!ini || st.st_size == 0)
+		goto close_file;
+	
+	/* Map private writable copy of the file, so that lines can be terminated in place */
+	ini->buffer_size = (size_t)st.st_size;
+	ini->buffer = mmap(NULL, ini->buffer_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	if (ini->buffer == MAP_FAILED) {
+		ini->buffer = NULL;
+		goto free_ini;
+	}
+	ini->buffer_mapped = 1;
+	madvise(ini->buffer, ini->buffer_size, MADV_SEQUENTIAL);
+	
+	/* Find room for terminating null: last newline can be replaced with it, 
+	 * otherwise zero-filled tail of the last page is used. File which fills 
+	 * its last page completely is read into the heap instead.
+	 */
+	if (ini->buffer[ini->buffer_size - 1] == '\n')
+		length = ini->buffer_size - 1;
+	else if (ini->buffer_size % (size_t)sysconf(_SC_PAGESIZE) != 0)
+		length = ini->buffer_size;
+	else {
+		munmap(ini->buffer, ini->buffer_size);
+		ini->buffer_mapped = 0;
+		ini->buffer = read_file(fd, ini->buffer_size);
+		if (!ini->buffer)
+			goto free_ini;
+		length = ini->buffer_size;
+	}
+	close(fd);
+	
+	/* Parse file contents */
+	parse_in_place(ini, ini->buffer, length);
+	return ini;
+	
+free_ini:
+	/* Free memory on error */
+	saved_errno = errno;
+	tini_free_ini(ini);
+	ini = NULL;
+	errno = saved_errno;
+	
+close_file:
+	/* Close file, preserving errno */
+	saved_errno = errno;
+	close(fd);
+	errno = saved_errno;
+	return ini;
+}
+
+#endif
+
+#if defined(TINI_FEATURE_SAVE_INI) || defined(TINI_FEATURE_BINARY_CACHE)
+
+static int write_file_atomically(const char* file_path, struct iovec* iov, int count) {
+	/* Temporary file is created next to the target file */
+	size_t length = strlen(file_path);
+	char* temp_path = allocate(NULL, length + 8);
+	int fd, saved_errno;
+	if (!temp_path)
+		return -1;
+	memcpy(temp_path, file_path, length);
+	memcpy(temp_path + length, ".XXXXXX", 8);
+	fd = mkstemp(temp_path);
+	if (fd < 0)
+		goto free_path;
+	
+	/* Write all data blocks at once, retry on interrupts and partial writes */
+	while (count > 0) {
+		ssize_t n = writev(fd, iov, count);
+		if (n < 0) {
+			if (errno != EINTR)
+				goto close_file;
+			continue;
+		}
+		while (count > 0 && (size_t)n >= iov->iov_len) {
+			n -= (ssize_t)iov->iov_len;
+			++iov;
+			--count;
+		}
+		if (count > 0) {
+			iov->iov_base = (char*)iov->iov_base + n;
+			iov->iov_len -= (size_t)n;
+		}
+	}
+	
+	/* Make file readable like regular files and flush it to disk */
+	if (fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0 || fsync(fd) != 0)
+		goto close_file;
+	if (close(fd) != 0)
+		goto remove_file;
+	
+	/* Replace target file, so that readers see either old or new file completely */
+	if (rename(temp_path, file_path) != 0)
+		goto remove_file;
+	deallocate(NULL, temp_path);
+	return 0;
+	
+close_file:
+	/* Close and remove temporary file on error */
+	saved_errno = errno;
+	close(fd);
+	errno = saved_errno;
+	
+remove_file:
+	saved_errno = errno;
+	unlink(temp_path);
+	errno = saved_errno;
+	
+free_path:
+	saved_errno = errno;
+	deallocate(NULL, temp_path);
+	errno = saved_errno;
+	return -1;
 }
 
 #endif
 
-#if defined(TINI_FEATURE_SAVE_INI) || defined(TINI_FEATURE_SAVE_INI)
+#if defined(TINI_FEATURE_SAVE_INI) || defined(TINI_FEATURE_DUMP_INI)
+
+static char* put_text(char* p, const char* s, size_t length) {
+	memcpy(p, s, length);
+	return p + length;
+}
+
+static size_t value_text_length(const char* s, size_t length) {
+	/* Lines of multi-line value after the first one are indented, so that they are parsed as continuation lines */
+	const char* end = s + length;
+	while ((s = memchr(s, '\n', end - s)) != NULL) {
+		++length;
+		++s;
+	}
+	return length;
+}
+
+static char* put_value(char* p, const char* s, size_t length) {
+	/* Copy value, indenting its continuation lines */
+	const char* end = s + length;
+	const char* eol;
+	while ((eol = memchr(s, '\n', end - s)) != NULL) {
+		p = put_text(p, s, eol + 1 - s);
+		*p++ = '\t';
+		s = eol + 1;
+	}
+	return put_text(p, s, end - s);
+}
+
+static int write_value(FILE* f, const char* s) {
+	/* Write value, indenting its continuation lines */
+	const char* eol;
+	while ((eol = strchr(s, '\n')) != NULL) {
+		if (fwrite(s, 1, eol + 1 - s, f) != (size_t)(eol + 1 - s) || fputc('\t', f) == EOF)
+			return -1;
+		s = eol + 1;
+	}
+	return fputs(s, f) == EOF ? -1 : 0;
+}
+
+char* tini_dump_to_buffer(const ini_file* ini, size_t* length) {
+	size_t i, j, size = 1;
+	char* buffer;
+	char* p;
+	
+	/* Calculate exact size of text: "[name]\n", "key=value\n" lines, empty line after each section, 
+	 * and terminating null. Tombstones of removed sections and parameters are skipped.
+	 */
+	for (i = 0; i < ini->section_count; ++i) {
+		const ini_section* s = ini->sections[i];
+		if (!s)
+			continue;
+		size += strlen(s->name) + 4;
+		for (j = 0; j < s->parameter_count; ++j) {
+			if (s->keys[j])
+				size += strlen(s->keys[j]) + value_text_length(s->values[j], strlen(s->values[j])) + 2;
+		}
+	}
+	
+	/* Copy all strings into single buffer */
+	buffer = allocate(ini, size);
+	if (!buffer)
+		return NULL;
+	p = buffer;
+	for (i = 0; i < ini->section_count; ++i) {
+		const ini_section* s = ini->sections[i];
+		if (!s)
+			continue;
+		*p++ = '[';
+		p = put_text(p, s->name, strlen(s->name));
+		*p++ = ']';
+		*p++ = '\n';
+		for (j = 0; j < s->parameter_count; ++j) {
+			if (!s->keys[j])
+				continue;
+			p = put_text(p, s->keys[j], strlen(s->keys[j]));
+			*p++ = '=';
+			p = put_value(p, s->values[j], strlen(s->values[j]));
+			*p++ = '\n';
+		}
+		*p++ = '\n';
+	}
+	*p = '\0';
+	
+	if (length)
+		*length = size - 1;
+	return buffer;
+}
 
 int tini_dump_ini(const ini_file* ini, FILE* f) {
 	size_t i, j;
 	
-	/* Enumerate all section */
+	/* Enumerate all section, skipping tombstones */
 	for (i = 0; i < ini->section_count; ++i) {
 		const ini_section* s = ini->sections[i];
+		if (!s)
+			continue;
 		
-		/* Write section header */
-		if(fprintf(f, "[%s]\n", s->name) < 0)
+		/* Write section header, without format string parsing */
+		if (fputc('[', f) == EOF || fputs(s->name, f) == EOF || fputs("]\n", f) == EOF)
 			return -1;
 		
 		/* Enumerate and write all parameters and values */
 		for (j = 0; j < s->parameter_count; ++j) {
-			if(fprintf(f, "%s=%s\n", s->keys[j], s->values[j]) < 0)
+			if (!s->keys[j])
+				continue;
+			if (fputs(s->keys[j], f) == EOF || fputc('=', f) == EOF 
+			    || write_value(f, s->values[j]) != 0 || fputc('\n', f) == EOF)
 				return -1;
 		}
 		
@@ -334,59 +1580,103 @@ int tini_dump_ini(const ini_file* ini, FILE* f) {
 
 #endif
 
-ini_section* tini_new_section(const char* name) {
-	/* Allocate memory for section object */
-	ini_section* section = malloc(sizeof(ini_section));
+#ifdef TINI_FEATURE_SAVE_INI
+
+int tini_save_ini(const ini_file* ini, const char* file_path) {
+	/* Serialize INI file object into single buffer */
+	struct iovec iov;
+	int res, saved_errno;
+	size_t length;
+	char* buffer = tini_dump_to_buffer(ini, &length);
+	if (!buffer)
+		return -1;
 	
-	if (section) {
-		/* Initialize section object, check result, indicate error if necessary */
-		if (initialize_section(section, name) != 0) {
-			int saved_errno = errno;
-			free(section);
-			section = NULL;
-			errno = saved_errno;
-		}
-	}
+	/* Write it with single system call into temporary file, which then replaces given file */
+	iov.iov_base = buffer;
+	iov.iov_len = length;
+	res = write_file_atomically(file_path, &iov, 1);
+	
+	/* Free buffer, preserving errno */
+	saved_errno = errno;
+	deallocate(ini, buffer);
+	errno = saved_errno;
+	return res;
+}
+
+#endif
+
+static ini_section* new_section(ini_file* owner, const char* name) {
+	/* Allocate single memory block for section object, its inline storage and name, 
+	 * unless name is referenced in the text buffer parsed in place
+	 */
+	size_t name_size = owner && owner->borrow_strings ? 0 : strlen(name) + 1;
+	ini_section* section = uses_arena(owner) 
+		? arena_alloc(owner, SECTION_INLINE_SIZE + name_size, ARENA_ALIGNMENT) 
+		: allocate(owner, SECTION_INLINE_SIZE + name_size);
+	
+	/* Initialize section object */
+	if (section)
+		initialize_section(section, owner, name, name_size);
 	
 	/* Return resulting object or NULL */
 	return section;
 }
 
+static void free_section(ini_section* section) {
+	/* Cleanup section object */
+	cleanup_section(section);
+	
+	/* Free memory, unless it belongs to the arena */
+	if (!uses_arena(section->owner))
+		deallocate(section->owner, section);
+}
+
+ini_section* tini_new_section(const char* name) {
+	return new_section(NULL, name);
+}
+
 void tini_free_section(ini_section* section) {
 	/* By convention, free()-like functions can accept NULL values */
-	if (section) {
-		/* Cleanup section object */
-		cleanup_section(section);
-		
-		/* Free memory */
-		free(section);
-	}
+	if (section)
+		free_section(section);
 }
 
 int tini_add_parameter(ini_file* ini, const char* section, const char* key, const char* value, int replace) {
 	/* Attempt to find section with given name */
-	ini_section* sectionObj = (ini_section*) tini_find_section(ini, section);
-	if (sectionObj) {
+	size_t i = find_section_index(ini, section);
+	if (i != 0) {
 		/* Section found - attempt adding parameter into it */
-		return tini_add_parameter_to_section(sectionObj, key, value, replace);
+		return tini_add_parameter_to_section(ini->sections[i - 1], key, value, replace);
 	} else {
 		/* Otherwise create new section */
-		sectionObj = tini_new_section(section);
+		ini_section* sectionObj = new_section(ini, section);
 		if (sectionObj) {
 			/* Attempt adding parameter to it */
 			if(tini_add_parameter_to_section(sectionObj, key, value, replace) == 0) {
-				/* Attempt to add section to sections storage */
-				if(ini->section_count < ini->max_section_count
-					|| (ini->section_count == ini->max_section_count
-					&& grow_section_storage(ini) == 0)) {
-					ini->sections[ini->section_count++] = sectionObj;
+#ifdef TINI_FEATURE_EDIT_INI
+				/* Reuse space of removed sections before growing full storage */
+				if (ini->section_count == ini->max_section_count)
+					compact_sections(ini);
+#endif
+				
+				/* Attempt to add section to sections storage and hash table */
+				if(reserve_section_storage(ini, ini->section_count + 1) == 0
+					&& reserve_section_index(ini, ini->section_count + 1) == 0) {
+					ini->sections[ini->section_count] = sectionObj;
+					insert_section_index(ini, ini->section_count++);
+					DROP_SECTION_VIEW(ini);
 					return 0;
-				} else
+				} else {
+					/* Indicate error */
+					int saved_errno = errno;
+					free_section(sectionObj);
+					errno = saved_errno;
 					return -1;
+				}
 			} else {
 				/* Indicate error */
 				int saved_errno = errno;
-				tini_free_section(sectionObj);
+				free_section(sectionObj);
 				errno = saved_errno;
 				return -1;
 			}
@@ -397,48 +1687,85 @@ int tini_add_parameter(ini_file* ini, const char* section, const char* key, cons
 	}
 }
 
-int tini_add_parameter_to_section(ini_section* section, const char* key, const char* value, int replace) {
+int tini_reserve_sections(ini_file* ini, size_t count) {
+	/* Pre-size both sections storage and hash table */
+	return reserve_section_storage(ini, count) == 0 && reserve_section_index(ini, count) == 0 ? 0 : -1;
+}
+
+int tini_reserve_parameters(ini_section* section, size_t count) {
+	/* Pre-size both parameters storage and hash table */
+	return reserve_parameter_storage(section, count) == 0 && reserve_key_index(section, count) == 0 ? 0 : -1;
+}
+
+static void set_last_parameter(ini_section* section, size_t i) {
+	/* Remember parameter, which continuation lines of its multi-line value are appended to */
+	ini_file* owner = section->owner;
+	if (owner) {
+		owner->last_section = section;
+		owner->last_parameter = i;
+		owner->last_value_size = 0;
+	}
+}
+
+static int add_parameter_to_section(ini_section* section, const char* key, const char* value, int replace) {
 	/* Check whether parameter with given name already exists */
 	size_t i = find_parameter_index_in_section(section, key);
+	
+	/* Section no longer matches INI file text it was parsed from */
+	section->text_hash = 0;
+	
 	if (i == 0) {
 		/* Create parameter name string */
 		char *new_key, *new_value;
-		new_key = strdup(key);
+		new_key = duplicate_string(section->owner, key);
 		if (!new_key)
 			return -1;
 		
 		/* Create parameter value string */
-		new_value = strdup(value);
+		new_value = duplicate_string(section->owner, value);
 		if (!new_value) {
-			free(new_key);
+			free_string(section->owner, new_key);
 			return -1;
 		}
 		
-		/* Attempt to add parameter to section, resize parameters storage if necessary */
-		if (section->parameter_count < section->max_parameter_count
-			|| (section->parameter_count == section->max_parameter_count
-			&& grow_parameter_storage(section) == 0)) {
+#ifdef TINI_FEATURE_EDIT_INI
+		/* Reuse space of removed parameters before growing full storage */
+		if (section->parameter_count == section->max_parameter_count)
+			compact_section(section);
+#endif
+		
+		/* Attempt to add parameter to section, resize parameters storage and hash table if necessary */
+		if (reserve_parameter_storage(section, section->parameter_count + 1) == 0
+			&& reserve_key_index(section, section->parameter_count + 1) == 0) {
 			section->keys[section->parameter_count] = new_key;
 			section->values[section->parameter_count] = new_value;
+			if (section->key_index)
+				insert_key_index(section, section->parameter_count);
+			set_last_parameter(section, section->parameter_count);
 			++section->parameter_count;
 			section->keys[section->parameter_count] = NULL;
 			section->values[section->parameter_count] = NULL;
+			DROP_PARAMETER_VIEW(section);
 			return 0;
 		} else {
 			/* Free memory and indicate error */
-			free(new_value);
-			free(new_key);
+			free_string(section->owner, new_value);
+			free_string(section->owner, new_key);
 			return -1;
 		}
 	} else if (replace) { /* Parameter exists and we can replace it */
 		/* Create new parameter value string */
-		char* new_value = strdup(value);
+		char* new_value = duplicate_string(section->owner, value);
 		if (new_value) {
 			--i;
 			/* Free old parameter value string */
-			free(section->values[i]);
-			/* Put new one in place */
+			free_string(section->owner, section->values[i]);
+			/* Put new one in place, forget values converted from the old one */
 			section->values[i] = new_value;
+			if (section->typed_values)
+				section->typed_values[i].state = 0;
+			DROP_PARAMETER_VIEW(section);
+			set_last_parameter(section, i);
 			return 0;
 		} else
 			return -1;
@@ -448,6 +1775,14 @@ int tini_add_parameter_to_section(ini_section* section, const char* key, const c
 	}
 }
 
+int tini_add_parameter_to_section(ini_section* section, const char* key, const char* value, int replace) {
+	int res;
+	STATS_TIMER(start);
+	res = add_parameter_to_section(section, key, value, replace);
+	STATS_ADD_TIME(section->owner, insert_ns, start);
+	return res;
+}
+
 #ifdef TINI_FEATURE_EDIT_INI
 
 int tini_remove_section(ini_file* ini, const char* section) {
@@ -476,41 +1811,24 @@ int tini_remove_parameter(ini_file* ini, const char* section, const char* key) {
 		return -1;
 	} else {
 		/* Section found, find parameter */
-		ini_section* sectionObj = ini->sections[--i];
-		j = find_parameter_index_in_section(s, key);
+		ini_section* sectionObj = ini->sections[i - 1];
+		j = find_parameter_index_in_section(sectionObj, key);
 		if(j == 0) {
 			/* Parameter not found, indicate error */
 			errno = ESRCH;
 			return -1;
 		} else {
-			/* Parameter found */
-			--j;
-			
-			/* Free parameter name and value strings */
-			free(sectionObj->values[j]);
-			free(sectionObj->keys[j]);
-			
-			/* Pack parameters array if parameter was in the beginning or middle */
-			if(i < s->parameter_count - 1) {
-				memmove(sectionObj->keys + i, sectionObj->keys + i + 1, 
-					sizeof(char*) * (sectionObj->parameter_count - i - 1));
-				memmove(sectionObj->values + i, sectionObj->values + i + 1, 
-					sizeof(char*) * (sectionObj->parameter_count - i - 1));
-			}
-			
-			/* Clear last parameters storage entries, so storage always finishes with NULLs */
-			s->keys[sectionObj->parameter_count] = NULL;
-			s->values[sectionObj->parameter_count] = NULL;
-			
-			/* Decreate parameter number */
-			--sectionObj->parameter_count;
-			
-			/* Indicate success */
+			/* Parameter found, remove it */
+			remove_parameter_by_index(sectionObj, j - 1);
 			return 0;
 		}
 	}
 }
 
+void tini_compact(ini_file* ini) {
+	compact_ini(ini);
+}
+
 #endif
 
 const ini_section* tini_find_section(const ini_file* ini, const char* section) {
@@ -537,34 +1855,2643 @@ const char* tini_find_parameter(const ini_file* ini, const char* section, const
 	return sectionObj ? tini_find_parameter_in_section(sectionObj, key, default_value) : default_value;
 }
 
+#ifdef TINI_FEATURE_STATS
+
+void tini_get_stats(const ini_file* ini, ini_stats* stats) {
+	/* Copy counters one by one, they may be updated concurrently */
+	const unsigned long long* from = (const unsigned long long*)(ini ? &ini->stats : &global_stats);
+	unsigned long long* to = (unsigned long long*)stats;
+	size_t i;
+	for (i = 0; i < sizeof(ini_stats) / sizeof(unsigned long long); ++i)
+		to[i] = __atomic_load_n(from + i, __ATOMIC_RELAXED);
+}
+
+void tini_reset_stats(ini_file* ini) {
+	unsigned long long* counters = (unsigned long long*)(ini ? &ini->stats : &global_stats);
+	size_t i;
+	for (i = 0; i < sizeof(ini_stats) / sizeof(unsigned long long); ++i)
+		__atomic_store_n(counters + i, 0, __ATOMIC_RELAXED);
+}
+
+#endif
+
 #ifdef TINI_FEATURE_GET_ELEMENT_COUNT
 
 size_t tini_get_parameter_count(const ini_section* section) {
-	return section->parameter_count;
+	return LIVE_PARAMETER_COUNT(section);
 }
 
 size_t tini_get_section_count(const ini_file* ini) {
+#ifdef TINI_FEATURE_EDIT_INI
+	return ini->section_count - ini->removed_section_count;
+#else
 	return ini->section_count;
+#endif
 }
 
 #endif
 
 #ifdef TINI_FEATURE_GET_PARAMETERS_STORAGE
 
-const char* const* tini_get_keys(const ini_section* section) {
-	return (const char* const*)section->keys;
-}
+#ifdef TINI_FEATURE_EDIT_INI
 
-const char* const* tini_get_values(const ini_section* section) {
-	return (const char* const*)section->values;
+static char** get_parameter_view(const ini_section* section) {
+	/* Make dense copy of keys followed by values on first use after removal. 
+	 * Concurrent readers may race to do it, only one copy is kept.
+	 */
+	char*** view_ptr = &((ini_section*)section)->view;
+	char** view = __atomic_load_n(view_ptr, __ATOMIC_ACQUIRE);
+	size_t i, j, count = LIVE_PARAMETER_COUNT(section);
+	if (view)
+		return view;
+	view = allocate(section->owner, sizeof(char*) * (count + 1) * 2);
+	if (!view)
+		return NULL;
+	for (i = j = 0; i < section->parameter_count; ++i) {
+		if (section->keys[i]) {
+			view[j] = section->keys[i];
+			view[count + 1 + j] = section->values[i];
+			++j;
+		}
+	}
+	view[count] = NULL;
+	view[count * 2 + 1] = NULL;
+	{
+		char** expected = NULL;
+		if (!__atomic_compare_exchange_n(view_ptr, &expected, view, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			deallocate(section->owner, view);
+			view = expected;
+		}
+	}
+	return view;
 }
 
 #endif
 
-#ifdef TINI_FEATURE_GET_SECTIONS_STORAGE
+const char* const* tini_get_keys(const ini_section* section) {
+#ifdef TINI_FEATURE_EDIT_INI
+	/* Storage with tombstones is exposed through its dense copy */
+	if (section->removed_parameter_count != 0)
+		return (const char* const*)get_parameter_view(section);
+#endif
+	return (const char* const*)section->keys;
+}
+
+const char* const* tini_get_values(const ini_section* section) {
+#ifdef TINI_FEATURE_EDIT_INI
+	/* Storage with tombstones is exposed through its dense copy, values follow keys there */
+	if (section->removed_parameter_count != 0) {
+		char** view = get_parameter_view(section);
+		return view ? (const char* const*)(view + LIVE_PARAMETER_COUNT(section) + 1) : NULL;
+	}
+#endif
+	return (const char* const*)section->values;
+}
+
+#endif
+
+#ifdef TINI_FEATURE_GET_SECTIONS_STORAGE
+
+#ifdef TINI_FEATURE_EDIT_INI
+
+static ini_section** get_section_view(const ini_file* ini) {
+	/* Make dense copy of sections on first use after removal. 
+	 * Concurrent readers may race to do it, only one copy is kept.
+	 */
+	ini_section*** view_ptr = &((ini_file*)ini)->view;
+	ini_section** view = __atomic_load_n(view_ptr, __ATOMIC_ACQUIRE);
+	size_t i, j;
+	if (view)
+		return view;
+	view = allocate(ini, sizeof(ini_section*) * (ini->section_count - ini->removed_section_count + 1));
+	if (!view)
+		return NULL;
+	for (i = j = 0; i < ini->section_count; ++i) {
+		if (ini->sections[i])
+			view[j++] = ini->sections[i];
+	}
+	view[j] = NULL;
+	{
+		ini_section** expected = NULL;
+		if (!__atomic_compare_exchange_n(view_ptr, &expected, view, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			deallocate(ini, view);
+			view = expected;
+		}
+	}
+	return view;
+}
+
+#endif
 
 const ini_section* const* tini_get_sections(const ini_file* ini) {
+#ifdef TINI_FEATURE_EDIT_INI
+	/* Storage with tombstones is exposed through its dense copy */
+	if (ini->removed_section_count != 0)
+		return (const ini_section* const*)get_section_view(ini);
+#endif
 	return (const ini_section* const*)ini->sections;
 }
 
 #endif
+
+#ifdef TINI_FEATURE_PARAMETER_HANDLES
+
+int tini_resolve(const ini_file* ini, const char* section, const char* key, ini_parameter_handle* handle) {
+	/* Find section and parameter, remember where it is */
+	const ini_section* sectionObj = tini_find_section(ini, section);
+	size_t i = sectionObj ? find_parameter_index_in_section(sectionObj, key) : 0;
+	if (i == 0) {
+		errno = ESRCH;
+		return -1;
+	}
+	handle->section = sectionObj;
+	handle->index = i - 1;
+	handle->generation = ini->generation;
+	return 0;
+}
+
+const char* tini_value_by_handle(const ini_file* ini, const ini_parameter_handle* handle) {
+	/* Section is dereferenced only when no section or parameter was destroyed since resolving */
+	return handle->generation == ini->generation && handle->index < handle->section->parameter_count 
+		? handle->section->values[handle->index] : NULL;
+}
+
+#endif
+
+#ifdef TINI_FEATURE_TYPED_VALUES
+
+static int lower_ascii(int c) {
+	/* Locale-independent lowercase conversion */
+	return c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c;
+}
+
+static int equal_ignore_case(const char* s, const char* lowercase) {
+	while (*lowercase && lower_ascii((unsigned char)*s) == *lowercase) {
+		++s;
+		++lowercase;
+	}
+	return *s == '\0' && *lowercase == '\0';
+}
+
+static int parse_int64(const char* s, uint64_t* bits) {
+	/* Decimal or 0x-prefixed hexadecimal number with optional sign */
+	uint64_t n = 0, limit;
+	int negative = 0, overflow = 0;
+	unsigned int base = 10;
+	const char* digits;
+	if (*s == '+' || *s == '-')
+		negative = *s++ == '-';
+	if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+		base = 16;
+		s += 2;
+	}
+	limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+	for (digits = s; ; ++s) {
+		unsigned int d;
+		if (*s >= '0' && *s <= '9')
+			d = *s - '0';
+		else if (base == 16 && lower_ascii(*s) >= 'a' && lower_ascii(*s) <= 'f')
+			d = lower_ascii(*s) - 'a' + 10;
+		else
+			break;
+		if (n > (limit - d) / base)
+			overflow = 1;
+		else
+			n = n * base + d;
+	}
+	
+	/* Syntax errors take precedence over overflow */
+	if (s == digits || *s)
+		return EINVAL;
+	if (overflow)
+		return ERANGE;
+	*bits = negative ? 0 - n : n;
+	return 0;
+}
+
+/* Powers of ten which are exactly representable as double */
+static const double exact_powers_of_ten[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static double strtod_c_locale(const char* s) {
+	/* Convert number in the "C" locale, so that decimal point is always '.' */
+	static locale_t c_locale = (locale_t)0;
+	locale_t loc = __atomic_load_n(&c_locale, __ATOMIC_ACQUIRE);
+	locale_t previous;
+	double d;
+	if (!loc) {
+		locale_t expected = (locale_t)0;
+		loc = newlocale(LC_ALL_MASK, "C", (locale_t)0);
+		if (loc && !__atomic_compare_exchange_n(&c_locale, &expected, loc, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			freelocale(loc);
+			loc = expected;
+		}
+		if (!loc)
+			return strtod(s, NULL);
+	}
+	previous = uselocale(loc);
+	d = strtod(s, NULL);
+	uselocale(previous);
+	return d;
+}
+
+static int parse_double(const char* s, uint64_t* bits) {
+	/* Validate syntax: optional sign, digits with optional fraction, optional exponent */
+	const char* p = s;
+	uint64_t mantissa = 0;
+	int digits = 0, significant = 0, exponent = 0, exponent_value = 0, exponent_negative = 0;
+	int negative = 0, exact = 1;
+	double d;
+	if (*p == '+' || *p == '-')
+		negative = *p++ == '-';
+	if (equal_ignore_case(p, "inf") || equal_ignore_case(p, "infinity")) {
+		d = negative ? -HUGE_VAL : HUGE_VAL;
+		memcpy(bits, &d, sizeof(d));
+		return 0;
+	}
+	if (equal_ignore_case(p, "nan")) {
+		d = strtod_c_locale(s);
+		memcpy(bits, &d, sizeof(d));
+		return 0;
+	}
+	for (; *p >= '0' && *p <= '9'; ++p, ++digits) {
+		if (significant < 19 && (mantissa != 0 || *p != '0')) {
+			mantissa = mantissa * 10 + (*p - '0');
+			++significant;
+		} else if (mantissa != 0) {
+			++exponent;
+			exact = 0;
+		}
+	}
+	if (*p == '.') {
+		for (++p; *p >= '0' && *p <= '9'; ++p, ++digits) {
+			if (significant < 19 && (mantissa != 0 || *p != '0')) {
+				mantissa = mantissa * 10 + (*p - '0');
+				++significant;
+				--exponent;
+			} else if (mantissa == 0)
+				--exponent;
+			else
+				exact = 0;
+		}
+	}
+	if (digits == 0)
+		return EINVAL;
+	if (*p == 'e' || *p == 'E') {
+		const char* exponent_digits;
+		++p;
+		if (*p == '+' || *p == '-')
+			exponent_negative = *p++ == '-';
+		for (exponent_digits = p; *p >= '0' && *p <= '9'; ++p) {
+			if (exponent_value < 100000)
+				exponent_value = exponent_value * 10 + (*p - '0');
+		}
+		if (p == exponent_digits)
+			return EINVAL;
+		exponent += exponent_negative ? -exponent_value : exponent_value;
+	}
+	if (*p)
+		return EINVAL;
+	
+	/* Fast path: mantissa and power of ten are exact doubles, so single operation rounds correctly */
+	if (exact && mantissa < ((uint64_t)1 << 53) && exponent >= -22 && exponent <= 22) {
+		d = (double)mantissa;
+		d = exponent < 0 ? d / exact_powers_of_ten[-exponent] : d * exact_powers_of_ten[exponent];
+		if (negative)
+			d = -d;
+	} else {
+		/* Otherwise let C library round it, checking overflow */
+		errno = 0;
+		d = strtod_c_locale(s);
+		if (errno == ERANGE && (d > 1.0 || d < -1.0))
+			return ERANGE;
+	}
+	memcpy(bits, &d, sizeof(d));
+	return 0;
+}
+
+static int parse_bool(const char* s, uint64_t* bits) {
+	/* Common spellings of boolean values, case-insensitive */
+	static const char* const true_values[] = { "1", "true", "yes", "on" };
+	static const char* const false_values[] = { "0", "false", "no", "off" };
+	size_t i;
+	for (i = 0; i < sizeof(true_values) / sizeof(true_values[0]); ++i) {
+		if (equal_ignore_case(s, true_values[i])) {
+			*bits = 1;
+			return 0;
+		}
+		if (equal_ignore_case(s, false_values[i])) {
+			*bits = 0;
+			return 0;
+		}
+	}
+	return EINVAL;
+}
+
+/* Duration units with their length in nanoseconds, longer names first */
+static const struct {
+	const char* name;
+	uint64_t nanoseconds;
+} duration_units[] = {
+	{ "ns", 1ULL },
+	{ "us", 1000ULL },
+	{ "ms", 1000000ULL },
+	{ "s", 1000000000ULL },
+	{ "m", 60000000000ULL },
+	{ "h", 3600000000000ULL },
+	{ "d", 86400000000000ULL }
+};
+
+static int parse_duration(const char* s, uint64_t* bits) {
+	/* Sequence of numbers with units, like "1h30m" or "2.5s", number without unit means seconds */
+	const uint64_t limit = (uint64_t)INT64_MAX;
+	uint64_t total = 0;
+	int negative = 0, overflow = 0;
+	const char* start;
+	if (*s == '+' || *s == '-')
+		negative = *s++ == '-';
+	if (!*s)
+		return EINVAL;
+	start = s;
+	while (*s) {
+		uint64_t whole = 0, fraction = 0, scale = 1, unit, amount;
+		const char* digits = s;
+		size_t i, length;
+		for (; *s >= '0' && *s <= '9'; ++s) {
+			if (whole > (limit - (*s - '0')) / 10)
+				overflow = 1;
+			else
+				whole = whole * 10 + (*s - '0');
+		}
+		if (*s == '.') {
+			for (++s; *s >= '0' && *s <= '9'; ++s) {
+				if (scale < 1000000000ULL) {
+					fraction = fraction * 10 + (*s - '0');
+					scale *= 10;
+				}
+			}
+		}
+		if (s == digits || (s == digits + 1 && *digits == '.'))
+			return EINVAL;
+		
+		/* Find unit, number without unit is allowed only alone */
+		for (i = 0; i < sizeof(duration_units) / sizeof(duration_units[0]); ++i) {
+			length = strlen(duration_units[i].name);
+			if (strncmp(s, duration_units[i].name, length) == 0)
+				break;
+		}
+		if (i < sizeof(duration_units) / sizeof(duration_units[0])) {
+			unit = duration_units[i].nanoseconds;
+			s += length;
+		} else if (!*s && digits == start) {
+			unit = duration_units[3].nanoseconds;
+		} else
+			return EINVAL;
+		
+		/* Add whole and fractional part, fraction / scale < 1, so its product with unit fits */
+		if (whole > (limit - total) / unit)
+			overflow = 1;
+		else {
+			amount = whole * unit + fraction * (unit / scale) + fraction * (unit % scale) / scale;
+			if (amount > limit - total)
+				overflow = 1;
+			else
+				total += amount;
+		}
+	}
+	if (overflow)
+		return ERANGE;
+	*bits = negative ? 0 - total : total;
+	return 0;
+}
+
+/* Converters by value kind */
+static int (* const typed_parsers[TYPED_KIND_COUNT])(const char*, uint64_t*) = {
+	parse_int64, parse_double, parse_bool, parse_duration
+};
+
+static int get_typed_value(const ini_section* section, const char* key, int kind, uint64_t* bits) {
+	struct _ini_typed_value** cache_ptr = &((ini_section*)section)->typed_values;
+	struct _ini_typed_value *cache, *entry;
+	uint32_t state;
+	int error;
+	
+	/* Find parameter */
+	size_t i = find_parameter_index_in_section(section, key);
+	if (i == 0) {
+		errno = ESRCH;
+		return -1;
+	}
+	
+	/* Allocate cache on first use. Concurrent readers may race to do it, only one cache is kept. */
+	cache = __atomic_load_n(cache_ptr, __ATOMIC_ACQUIRE);
+	if (!cache) {
+		struct _ini_typed_value* expected = NULL;
+		cache = allocate_zeroed(section->owner, sizeof(struct _ini_typed_value) * section->max_parameter_count);
+		if (cache && !__atomic_compare_exchange_n(cache_ptr, &expected, cache, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			deallocate(section->owner, cache);
+			cache = expected;
+		}
+	}
+	
+	/* Convert value unless it is cached, and cache the result. Without cache, just convert it. */
+	entry = cache ? cache + i - 1 : NULL;
+	state = entry ? __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE) : 0;
+	if (state & TYPED_CACHED(kind)) {
+		uint64_t cached = __atomic_load_n(&entry->values[kind], __ATOMIC_RELAXED);
+		if (state & TYPED_FAILED(kind))
+			error = (int)cached;
+		else {
+			*bits = cached;
+			error = 0;
+		}
+	} else {
+		uint64_t converted = 0;
+		error = typed_parsers[kind](section->values[i - 1], &converted);
+		if (entry) {
+			__atomic_store_n(&entry->values[kind], error ? (uint64_t)error : converted, __ATOMIC_RELAXED);
+			__atomic_fetch_or(&entry->state, TYPED_CACHED(kind) | (error ? TYPED_FAILED(kind) : 0), __ATOMIC_RELEASE);
+		}
+		if (!error)
+			*bits = converted;
+	}
+	
+	if (error) {
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+static int get_typed_parameter(const ini_file* ini, const char* section, const char* key, int kind, uint64_t* bits) {
+	const ini_section* sectionObj = tini_find_section(ini, section);
+	if (!sectionObj) {
+		errno = ESRCH;
+		return -1;
+	}
+	return get_typed_value(sectionObj, key, kind, bits);
+}
+
+int tini_get_int64_in_section(const ini_section* section, const char* key, int64_t* value) {
+	uint64_t bits;
+	if (get_typed_value(section, key, TYPED_INT64, &bits) != 0)
+		return -1;
+	*value = (int64_t)bits;
+	return 0;
+}
+
+int tini_get_int64(const ini_file* ini, const char* section, const char* key, int64_t* value) {
+	uint64_t bits;
+	if (get_typed_parameter(ini, section, key, TYPED_INT64, &bits) != 0)
+		return -1;
+	*value = (int64_t)bits;
+	return 0;
+}
+
+int tini_get_double_in_section(const ini_section* section, const char* key, double* value) {
+	uint64_t bits;
+	if (get_typed_value(section, key, TYPED_DOUBLE, &bits) != 0)
+		return -1;
+	memcpy(value, &bits, sizeof(*value));
+	return 0;
+}
+
+int tini_get_double(const ini_file* ini, const char* section, const char* key, double* value) {
+	uint64_t bits;
+	if (get_typed_parameter(ini, section, key, TYPED_DOUBLE, &bits) != 0)
+		return -1;
+	memcpy(value, &bits, sizeof(*value));
+	return 0;
+}
+
+int tini_get_bool_in_section(const ini_section* section, const char* key, int* value) {
+	uint64_t bits;
+	if (get_typed_value(section, key, TYPED_BOOL, &bits) != 0)
+		return -1;
+	*value = (int)bits;
+	return 0;
+}
+
+int tini_get_bool(const ini_file* ini, const char* section, const char* key, int* value) {
+	uint64_t bits;
+	if (get_typed_parameter(ini, section, key, TYPED_BOOL, &bits) != 0)
+		return -1;
+	*value = (int)bits;
+	return 0;
+}
+
+int tini_get_duration_in_section(const ini_section* section, const char* key, int64_t* nanoseconds) {
+	uint64_t bits;
+	if (get_typed_value(section, key, TYPED_DURATION, &bits) != 0)
+		return -1;
+	*nanoseconds = (int64_t)bits;
+	return 0;
+}
+
+int tini_get_duration(const ini_file* ini, const char* section, const char* key, int64_t* nanoseconds) {
+	uint64_t bits;
+	if (get_typed_parameter(ini, section, key, TYPED_DURATION, &bits) != 0)
+		return -1;
+	*nanoseconds = (int64_t)bits;
+	return 0;
+}
+
+#endif
+
+#ifdef TINI_FEATURE_OVERLAY
+
+/* Minimum size increment of the layer storage, overlays usually have few layers */
+#define OVERLAY_LAYER_STORAGE_SIZE_INCREMENT 4
+
+/* Cached result of parameter lookup in INI file overlay */
+struct _ini_overlay_entry {
+	size_t hash; /* combined hash of section and parameter names, or zero if entry is empty */
+	const char* section; /* section name, owned by the layer */
+	const char* key; /* parameter name, owned by the layer */
+	const char* value; /* parameter value, owned by the layer */
+};
+
+struct _ini_overlay {
+	const ini_file** layers; /* array of layers, from bottom to top */
+	size_t layer_count; /* number of layers */
+	size_t max_layer_count; /* maximum number of layers for which memory is currently allocated */
+	struct _ini_overlay_entry* cache; /* direct-mapped cache of found parameters, or NULL */
+	size_t cache_size; /* number of cache entries, power of two */
+};
+
+ini_overlay* tini_create_overlay(size_t cache_size) {
+	ini_overlay* overlay = allocate(NULL, sizeof(ini_overlay));
+	if (!overlay)
+		return NULL;
+	overlay->layers = NULL;
+	overlay->layer_count = 0;
+	overlay->max_layer_count = 0;
+	overlay->cache = NULL;
+	overlay->cache_size = 0;
+	
+	/* Round cache size up to power of two, so that entry can be selected by mask */
+	if (cache_size != 0) {
+		size_t size = 1;
+		while (size < cache_size)
+			size *= 2;
+		overlay->cache = allocate_zeroed(NULL, sizeof(struct _ini_overlay_entry) * size);
+		if (!overlay->cache) {
+			deallocate(NULL, overlay);
+			return NULL;
+		}
+		overlay->cache_size = size;
+	}
+	return overlay;
+}
+
+void tini_free_overlay(ini_overlay* overlay) {
+	if (overlay) {
+		deallocate(NULL, overlay->layers);
+		deallocate(NULL, overlay->cache);
+		deallocate(NULL, overlay);
+	}
+}
+
+int tini_push_layer(ini_overlay* overlay, const ini_file* layer) {
+	if (!layer) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (overlay->layer_count == overlay->max_layer_count) {
+		size_t new_max_layer_count = grow_storage_size(overlay->max_layer_count, overlay->layer_count + 1, 
+			OVERLAY_LAYER_STORAGE_SIZE_INCREMENT);
+		const ini_file** layers = reallocate(NULL, (void*)overlay->layers, sizeof(const ini_file*) * new_max_layer_count);
+		if (!layers)
+			return -1;
+		overlay->layers = layers;
+		overlay->max_layer_count = new_max_layer_count;
+	}
+	overlay->layers[overlay->layer_count++] = layer;
+	
+	/* New layer may hide cached parameters */
+	tini_clear_overlay_cache(overlay);
+	return 0;
+}
+
+void tini_clear_overlay_cache(ini_overlay* overlay) {
+	if (overlay->cache)
+		memset(overlay->cache, 0, sizeof(struct _ini_overlay_entry) * overlay->cache_size);
+}
+
+int tini_overlay_has_section(const ini_overlay* overlay, const char* section) {
+	/* Hash section name once for all layers */
+	size_t hash = hash_string(section), i;
+	for (i = 0; i < overlay->layer_count; ++i) {
+		if (find_section_index_by_hash(overlay->layers[i], section, hash) != 0)
+			return 1;
+	}
+	return 0;
+}
+
+const char* tini_overlay_find_parameter(ini_overlay* overlay, const char* section, const char* key, const char* default_value) {
+	size_t section_hash = hash_string(section), key_hash = hash_string(key), hash = 0, i;
+	struct _ini_overlay_entry* entry = NULL;
+	
+	/* Check cache first, zero hash marks empty entries */
+	if (overlay->cache) {
+		hash = (section_hash * 31 + key_hash) | 1;
+		entry = overlay->cache + (hash & (overlay->cache_size - 1));
+		if (entry->hash == hash && strcmp(entry->key, key) == 0 && strcmp(entry->section, section) == 0)
+			return entry->value;
+	}
+	
+	/* Check layers from top to bottom, hashing names only once */
+	for (i = overlay->layer_count; i-- > 0;) {
+		const ini_file* layer = overlay->layers[i];
+		size_t j = find_section_index_by_hash(layer, section, section_hash), k;
+		if (j == 0)
+			continue;
+		k = find_parameter_index_by_hash(layer->sections[j - 1], key, key_hash);
+		if (k != 0) {
+			const ini_section* s = layer->sections[j - 1];
+			if (entry) {
+				entry->hash = hash;
+				entry->section = s->name;
+				entry->key = s->keys[k - 1];
+				entry->value = s->values[k - 1];
+			}
+			return s->values[k - 1];
+		}
+	}
+	
+	/* Missing parameters aren't cached */
+	return default_value;
+}
+
+size_t tini_get_layer_count(const ini_overlay* overlay) {
+	return overlay->layer_count;
+}
+
+#endif
+
+#ifdef TINI_FEATURE_FREEZE_INI
+
+/* Signature, byte order mark and version of the frozen INI file snapshot layout */
+#define FROZEN_MAGIC "TINIFRZ"
+#define FROZEN_BYTE_ORDER 0x01020304u
+#define FROZEN_VERSION 1u
+
+/* Frozen INI file snapshot header. Snapshot is single block of memory, where header 
+ * is followed by tables and string pool, all addressed by offsets from the block start, 
+ * so that it can be saved into a file and mapped back into memory at any address.
+ */
+struct _ini_frozen_header {
+	char magic[8]; /* FROZEN_MAGIC */
+	uint32_t byte_order; /* FROZEN_BYTE_ORDER */
+	uint32_t version; /* FROZEN_VERSION */
+	uint32_t size; /* total size of the snapshot in bytes */
+	uint32_t seed; /* seed of hashes used by perfect hash functions */
+	uint32_t section_count; /* number of sections */
+	uint32_t parameter_count; /* number of parameters */
+	uint32_t section_bucket_count; /* number of section hash buckets */
+	uint32_t parameter_bucket_count; /* number of parameter hash buckets */
+	uint32_t sections; /* offset of frozen sections table, in the original order */
+	uint32_t section_buckets; /* offset of section hash bucket displacements */
+	uint32_t section_slots; /* offset of section indexes by perfect hash slot */
+	uint32_t parameters; /* offset of frozen parameters table, by perfect hash slot */
+	uint32_t parameter_buckets; /* offset of parameter hash bucket displacements */
+	uint32_t parameter_order; /* offset of parameter slots in the original order */
+	uint32_t strings; /* offset of string pool */
+	uint32_t strings_size; /* size of string pool */
+	uint64_t source_size; /* size of the source INI file, for binary cache files */
+	int64_t source_mtime; /* modification time of the source INI file, seconds */
+	uint32_t source_mtime_nsec; /* modification time of the source INI file, nanoseconds */
+	uint32_t reserved; /* reserved, zero */
+};
+
+/* Frozen INI file snapshot handle */
+struct _ini_frozen {
+	const struct _ini_frozen_header* header; /* snapshot */
+	size_t mapped_size; /* size of the mapped binary cache file, or zero if snapshot follows this handle */
+};
+
+/* Offset of the snapshot allocated together with its handle */
+#define FROZEN_HANDLE_SIZE ((sizeof(struct _ini_frozen) + 7) & ~(size_t)7)
+
+/* Frozen section */
+struct _ini_frozen_section {
+	uint32_t hash; /* lower half of section name hash */
+	uint32_t name; /* offset of section name in the string pool */
+	uint32_t first_parameter; /* index of the first section parameter in parameter order table */
+	uint32_t parameter_count; /* number of section parameters */
+};
+
+/* Frozen parameter. Its section name, parameter name and value are stored together 
+ * in the string pool as "section\0key\0value\0".
+ */
+struct _ini_frozen_parameter {
+	uint32_t hash; /* lower half of section and parameter name hash */
+	uint32_t section; /* index of the section */
+	uint32_t pair; /* offset of section and parameter name pair in the string pool */
+	uint32_t value; /* offset of parameter value in the string pool */
+};
+
+/* Access snapshot table at given offset */
+#define FROZEN_TABLE(header, type, offset) ((const type*)((const char*)(header) + (header)->offset))
+
+/* Bucket displacement flag, which means that bucket has single element and displacement is its slot */
+#define FROZEN_DIRECT_SLOT 0x80000000u
+
+/* Maximum number of displacements tried for a single bucket, and number of hash seeds tried */
+#define FROZEN_MAX_DISPLACEMENT 0x100000u
+#define FROZEN_MAX_ATTEMPTS 16
+
+static uint64_t frozen_hash_seed(uint32_t seed) {
+	/* Derive FNV-1a initial value from hash seed */
+	return HASH_BASIS ^ ((uint64_t)seed * 0x9E3779B97F4A7C15ULL);
+}
+
+static uint32_t frozen_range(uint32_t h, uint32_t count) {
+	/* Map 32-bit hash onto range [0, count) with multiplication instead of division */
+	return (uint32_t)(((uint64_t)h * count) >> 32);
+}
+
+static uint32_t frozen_bucket(uint64_t hash, uint32_t bucket_count) {
+	/* Bucket is selected by upper half of the mixed hash. Upper bits of FNV-1a hashes of names 
+	 * which differ only in last characters are nearly the same, so they would share few buckets.
+	 */
+	hash ^= hash >> 30;
+	hash *= 0xBF58476D1CE4E5B9ULL;
+	hash ^= hash >> 27;
+	return frozen_range((uint32_t)(hash >> 32), bucket_count);
+}
+
+static uint32_t frozen_slot(uint64_t hash, uint32_t displacement, uint32_t count) {
+	/* Mix hash with displacement and map it onto hash slots */
+	uint64_t h = hash + (uint64_t)(displacement + 1) * 0x9E3779B97F4A7C15ULL;
+	h ^= h >> 33;
+	h *= 0xFF51AFD7ED558CCDULL;
+	h ^= h >> 33;
+	return frozen_range((uint32_t)(h >> 32), count);
+}
+
+static uint32_t frozen_lookup_slot(const uint32_t* buckets, uint32_t bucket_count, uint64_t hash, uint32_t count) {
+	/* Find slot of the given hash by displacement of its bucket */
+	uint32_t displacement = buckets[frozen_bucket(hash, bucket_count)];
+	return (displacement & FROZEN_DIRECT_SLOT) ? displacement & ~FROZEN_DIRECT_SLOT 
+		: frozen_slot(hash, displacement, count);
+}
+
+static int build_perfect_hash(const uint64_t* hashes, uint32_t count, uint32_t bucket_count, 
+			      uint32_t* buckets, uint32_t* slots) {
+	/* Hash and displace: items are distributed into buckets, then buckets, largest first, 
+	 * are given displacements which move all their items into distinct free slots. 
+	 * Slots map to item indexes, buckets get displacements.
+	 */
+	uint32_t* bucket_start = allocate(NULL, sizeof(uint32_t) * (bucket_count + 1));
+	uint32_t* items = allocate(NULL, sizeof(uint32_t) * (count + 1));
+	uint32_t* order = allocate(NULL, sizeof(uint32_t) * (bucket_count + 1));
+	uint32_t* size_start = NULL;
+	uint32_t i, j, max_size = 0, free_slot = 0;
+	int res = -1;
+	
+	if (!bucket_start || !items || !order)
+		goto exit;
+	
+	/* Group items by bucket with counting sort */
+	memset(bucket_start, 0, sizeof(uint32_t) * (bucket_count + 1));
+	for (i = 0; i < count; ++i)
+		++bucket_start[frozen_bucket(hashes[i], bucket_count) + 1];
+	for (i = 0; i < bucket_count; ++i) {
+		if (bucket_start[i + 1] > max_size)
+			max_size = bucket_start[i + 1];
+		bucket_start[i + 1] += bucket_start[i];
+	}
+	for (i = 0; i < count; ++i)
+		items[bucket_start[frozen_bucket(hashes[i], bucket_count)]++] = i;
+	for (i = bucket_count; i > 0; --i)
+		bucket_start[i] = bucket_start[i - 1];
+	bucket_start[0] = 0;
+	
+	/* Order buckets by size, largest first, with counting sort */
+	size_start = allocate(NULL, sizeof(uint32_t) * (max_size + 2));
+	if (!size_start)
+		goto exit;
+	memset(size_start, 0, sizeof(uint32_t) * (max_size + 2));
+	for (i = 0; i < bucket_count; ++i)
+		++size_start[max_size - (bucket_start[i + 1] - bucket_start[i]) + 1];
+	for (i = 0; i <= max_size; ++i)
+		size_start[i + 1] += size_start[i];
+	for (i = 0; i < bucket_count; ++i)
+		order[size_start[max_size - (bucket_start[i + 1] - bucket_start[i])]++] = i;
+	
+	/* Mark all slots free */
+	for (i = 0; i < count; ++i)
+		slots[i] = UINT32_MAX;
+	
+	/* Place buckets */
+	for (i = 0; i < bucket_count; ++i) {
+		uint32_t b = order[i];
+		uint32_t first = bucket_start[b], size = bucket_start[b + 1] - first, d;
+		
+		if (size == 0) {
+			/* Empty buckets are never used by lookups of existing items */
+			buckets[b] = 0;
+		} else if (size == 1) {
+			/* Single item goes right into the next free slot */
+			while (slots[free_slot] != UINT32_MAX)
+				++free_slot;
+			slots[free_slot] = items[first];
+			buckets[b] = free_slot | FROZEN_DIRECT_SLOT;
+		} else {
+			/* Try displacements until all items of the bucket land into distinct free slots */
+			for (d = 0; d < FROZEN_MAX_DISPLACEMENT; ++d) {
+				for (j = 0; j < size; ++j) {
+					uint32_t slot = frozen_slot(hashes[items[first + j]], d, count);
+					if (slots[slot] != UINT32_MAX)
+						break;
+					slots[slot] = items[first + j];
+				}
+				if (j == size)
+					break;
+				
+				/* Collision - roll back slots taken by this displacement */
+				while (j-- > 0)
+					slots[frozen_slot(hashes[items[first + j]], d, count)] = UINT32_MAX;
+			}
+			if (d == FROZEN_MAX_DISPLACEMENT) {
+				errno = EAGAIN;
+				goto exit;
+			}
+			buckets[b] = d;
+		}
+	}
+	res = 0;
+	
+exit:
+	/* Free temporary memory */
+	deallocate(NULL, size_start);
+	deallocate(NULL, order);
+	deallocate(NULL, items);
+	deallocate(NULL, bucket_start);
+	return res;
+}
+
+static size_t layout_frozen(struct _ini_frozen_header* h, size_t section_count, size_t parameter_count, 
+			    size_t strings_size) {
+	/* Place tables one after another, checking that all offsets fit 32 bits */
+	uint64_t size = sizeof(*h);
+	if (section_count > UINT32_MAX / 2 || parameter_count > UINT32_MAX / 2) {
+		errno = EOVERFLOW;
+		return 0;
+	}
+	h->section_count = (uint32_t)section_count;
+	h->parameter_count = (uint32_t)parameter_count;
+	h->section_bucket_count = h->section_count / 2 + 1;
+	h->parameter_bucket_count = h->parameter_count / 2 + 1;
+	h->sections = (uint32_t)size;
+	size += sizeof(struct _ini_frozen_section) * (uint64_t)section_count;
+	h->section_buckets = (uint32_t)size;
+	size += sizeof(uint32_t) * (uint64_t)h->section_bucket_count;
+	h->section_slots = (uint32_t)size;
+	size += sizeof(uint32_t) * (uint64_t)section_count;
+	h->parameters = (uint32_t)size;
+	size += sizeof(struct _ini_frozen_parameter) * (uint64_t)parameter_count;
+	h->parameter_buckets = (uint32_t)size;
+	size += sizeof(uint32_t) * (uint64_t)h->parameter_bucket_count;
+	h->parameter_order = (uint32_t)size;
+	size += sizeof(uint32_t) * (uint64_t)parameter_count;
+	h->strings = (uint32_t)size;
+	h->strings_size = (uint32_t)strings_size;
+	size += strings_size;
+	if (size > UINT32_MAX) {
+		errno = EOVERFLOW;
+		return 0;
+	}
+	h->size = (uint32_t)size;
+	return (size_t)size;
+}
+
+ini_frozen* tini_freeze(const ini_file* ini) {
+	ini_frozen* frozen = NULL;
+	uint64_t* section_hashes = NULL;
+	uint64_t* parameter_hashes = NULL;
+	uint32_t* parameter_sections = NULL;
+	uint32_t* parameter_keys = NULL;
+	uint32_t* section_buckets = NULL;
+	uint32_t* parameter_buckets = NULL;
+	uint32_t* section_slots = NULL;
+	uint32_t* parameter_slots = NULL;
+	const ini_section** sections = NULL;
+	struct _ini_frozen_header header;
+	size_t i, j, n, section_count, strings_size = 0, size;
+	uint32_t attempt;
+	int saved_errno;
+	
+	/* Collect sections, skipping tombstones of removed ones, count parameters and string pool size */
+	sections = allocate(NULL, sizeof(ini_section*) * (ini->section_count + 1));
+	if (!sections)
+		return NULL;
+	memset(&header, 0, sizeof(header));
+	n = 0;
+	section_count = 0;
+	for (i = 0; i < ini->section_count; ++i) {
+		const ini_section* s = ini->sections[i];
+		size_t name_size;
+		if (!s)
+			continue;
+		sections[section_count++] = s;
+		name_size = strlen(s->name) + 1;
+		strings_size += name_size;
+		for (j = 0; j < s->parameter_count; ++j) {
+			if (s->keys[j])
+				strings_size += name_size + strlen(s->keys[j]) + strlen(s->values[j]) + 2;
+		}
+		n += LIVE_PARAMETER_COUNT(s);
+	}
+	
+	/* Lay out snapshot */
+	size = layout_frozen(&header, section_count, n, strings_size);
+	if (size == 0)
+		goto exit;
+	
+	/* Allocate temporary tables */
+	section_hashes = allocate(NULL, sizeof(uint64_t) * (section_count + 1));
+	parameter_hashes = allocate(NULL, sizeof(uint64_t) * (n + 1));
+	parameter_sections = allocate(NULL, sizeof(uint32_t) * (n + 1));
+	parameter_keys = allocate(NULL, sizeof(uint32_t) * (n + 1));
+	section_buckets = allocate(NULL, sizeof(uint32_t) * header.section_bucket_count);
+	parameter_buckets = allocate(NULL, sizeof(uint32_t) * header.parameter_bucket_count);
+	section_slots = allocate(NULL, sizeof(uint32_t) * (section_count + 1));
+	parameter_slots = allocate(NULL, sizeof(uint32_t) * (n + 1));
+	if (!section_hashes || !parameter_hashes || !parameter_sections || !parameter_keys 
+		|| !section_buckets || !parameter_buckets || !section_slots || !parameter_slots)
+		goto exit;
+	
+	/* Build perfect hash functions, trying another hash seed if the current one doesn't work */
+	for (attempt = 0; attempt < FROZEN_MAX_ATTEMPTS; ++attempt) {
+		uint64_t basis = frozen_hash_seed(attempt);
+		size_t k = 0;
+		for (i = 0; i < section_count; ++i) {
+			const ini_section* s = sections[i];
+			uint64_t h = hash_bytes(basis, s->name);
+			section_hashes[i] = h;
+			for (j = 0; j < s->parameter_count; ++j) {
+				if (!s->keys[j])
+					continue;
+				parameter_hashes[k] = hash_bytes(h, s->keys[j]);
+				parameter_sections[k] = (uint32_t)i;
+				parameter_keys[k] = (uint32_t)j;
+				++k;
+			}
+		}
+		if (build_perfect_hash(section_hashes, header.section_count, header.section_bucket_count, 
+				section_buckets, section_slots) == 0
+			&& build_perfect_hash(parameter_hashes, header.parameter_count, header.parameter_bucket_count, 
+				parameter_buckets, parameter_slots) == 0)
+			break;
+		if (errno != EAGAIN)
+			goto exit;
+	}
+	if (attempt == FROZEN_MAX_ATTEMPTS)
+		goto exit;
+	header.seed = attempt;
+	
+	/* Allocate handle together with snapshot */
+	frozen = allocate(NULL, FROZEN_HANDLE_SIZE + size);
+	if (frozen) {
+		char* block = (char*)frozen + FROZEN_HANDLE_SIZE;
+		struct _ini_frozen_section* frozen_sections;
+		struct _ini_frozen_parameter* parameters;
+		uint32_t* order;
+		char* strings;
+		size_t offset = 0;
+		
+		/* Fill header and copy hash tables */
+		memcpy(header.magic, FROZEN_MAGIC, sizeof(header.magic));
+		header.byte_order = FROZEN_BYTE_ORDER;
+		header.version = FROZEN_VERSION;
+		memcpy(block, &header, sizeof(header));
+		frozen->header = (const struct _ini_frozen_header*)block;
+		frozen->mapped_size = 0;
+		memcpy(block + header.section_buckets, section_buckets, sizeof(uint32_t) * header.section_bucket_count);
+		memcpy(block + header.section_slots, section_slots, sizeof(uint32_t) * header.section_count);
+		memcpy(block + header.parameter_buckets, parameter_buckets, sizeof(uint32_t) * header.parameter_bucket_count);
+		frozen_sections = (struct _ini_frozen_section*)(block + header.sections);
+		parameters = (struct _ini_frozen_parameter*)(block + header.parameters);
+		order = (uint32_t*)(block + header.parameter_order);
+		strings = block + header.strings;
+		
+		/* Copy section names into the string pool */
+		for (i = 0; i < section_count; ++i) {
+			size_t length = strlen(sections[i]->name) + 1;
+			frozen_sections[i].hash = (uint32_t)section_hashes[i];
+			frozen_sections[i].name = (uint32_t)offset;
+			frozen_sections[i].parameter_count = (uint32_t)LIVE_PARAMETER_COUNT(sections[i]);
+			frozen_sections[i].first_parameter = 0;
+			memcpy(strings + offset, sections[i]->name, length);
+			offset += length;
+		}
+		
+		/* Fill parameters by their slots, copy names and values into the string pool */
+		for (i = 0; i < n; ++i) {
+			struct _ini_frozen_parameter* p = &parameters[i];
+			size_t k = parameter_slots[i];
+			const ini_section* s = sections[parameter_sections[k]];
+			const char* key = s->keys[parameter_keys[k]];
+			const char* value = s->values[parameter_keys[k]];
+			size_t name_length = strlen(s->name) + 1;
+			size_t key_length = strlen(key) + 1, value_length = strlen(value) + 1;
+			p->hash = (uint32_t)parameter_hashes[k];
+			p->section = parameter_sections[k];
+			p->pair = (uint32_t)offset;
+			memcpy(strings + offset, s->name, name_length);
+			offset += name_length;
+			memcpy(strings + offset, key, key_length);
+			offset += key_length;
+			p->value = (uint32_t)offset;
+			memcpy(strings + offset, value, value_length);
+			offset += value_length;
+			
+			/* Parameter slots in the original order */
+			order[k] = (uint32_t)i;
+		}
+		
+		/* Link sections to their parameters in the original order */
+		for (i = 1; i < section_count; ++i)
+			frozen_sections[i].first_parameter = frozen_sections[i - 1].first_parameter 
+				+ frozen_sections[i - 1].parameter_count;
+	}
+	
+exit:
+	/* Free temporary tables */
+	saved_errno = errno;
+	deallocate(NULL, parameter_slots);
+	deallocate(NULL, section_slots);
+	deallocate(NULL, parameter_buckets);
+	deallocate(NULL, section_buckets);
+	deallocate(NULL, parameter_keys);
+	deallocate(NULL, parameter_sections);
+	deallocate(NULL, parameter_hashes);
+	deallocate(NULL, section_hashes);
+	deallocate(NULL, sections);
+	errno = saved_errno;
+	return frozen;
+}
+
+void tini_free_frozen(ini_frozen* frozen) {
+	/* By convention, free()-like functions accept NULL input */
+	if (frozen) {
+#ifdef TINI_FEATURE_BINARY_CACHE
+		/* Unmap binary cache file */
+		if (frozen->mapped_size)
+			munmap((void*)frozen->header, frozen->mapped_size);
+#endif
+		deallocate(NULL, frozen);
+	}
+}
+
+static const struct _ini_frozen_section* find_frozen_section(const struct _ini_frozen_header* h, const char* section) {
+	const struct _ini_frozen_section* s;
+	uint64_t hash;
+	
+	/* Empty snapshot has no sections */
+	if (h->section_count == 0)
+		return NULL;
+	
+	/* Hash section name, find its only possible slot and compare section there */
+	hash = hash_bytes(frozen_hash_seed(h->seed), section);
+	s = FROZEN_TABLE(h, struct _ini_frozen_section, sections) + FROZEN_TABLE(h, uint32_t, section_slots)[
+		frozen_lookup_slot(FROZEN_TABLE(h, uint32_t, section_buckets), h->section_bucket_count, 
+			hash, h->section_count)];
+	return s->hash == (uint32_t)hash 
+		&& strcmp(FROZEN_TABLE(h, char, strings) + s->name, section) == 0 ? s : NULL;
+}
+
+int tini_frozen_has_section(const ini_frozen* frozen, const char* section) {
+	return find_frozen_section(frozen->header, section) != NULL;
+}
+
+const char* tini_frozen_find_parameter(const ini_frozen* frozen, const char* section, const char* key, const char* default_value) {
+	const struct _ini_frozen_header* h = frozen->header;
+	const struct _ini_frozen_parameter* p;
+	uint64_t hash;
+	
+	/* Empty snapshot has no parameters */
+	if (h->parameter_count == 0)
+		return default_value;
+	
+	/* Hash section and parameter name together, find their only possible slot */
+	hash = hash_bytes(hash_bytes(frozen_hash_seed(h->seed), section), key);
+	p = FROZEN_TABLE(h, struct _ini_frozen_parameter, parameters) + frozen_lookup_slot(
+		FROZEN_TABLE(h, uint32_t, parameter_buckets), h->parameter_bucket_count, 
+		hash, h->parameter_count);
+	
+	/* Compare section and parameter name pair found in the slot, value follows the pair */
+	if (p->hash == (uint32_t)hash) {
+		const char* pair = FROZEN_TABLE(h, char, strings) + p->pair;
+		while (*pair == *section && *section) {
+			++pair;
+			++section;
+		}
+		if (*pair++ == *section && strcmp(pair, key) == 0)
+			return FROZEN_TABLE(h, char, strings) + p->value;
+	}
+	return default_value;
+}
+
+size_t tini_frozen_get_section_count(const ini_frozen* frozen) {
+	return frozen->header->section_count;
+}
+
+size_t tini_frozen_get_parameter_count(const ini_frozen* frozen) {
+	return frozen->header->parameter_count;
+}
+
+ini_file* tini_thaw(const ini_frozen* frozen) {
+	const struct _ini_frozen_header* h = frozen->header;
+	const struct _ini_frozen_section* sections = FROZEN_TABLE(h, struct _ini_frozen_section, sections);
+	const struct _ini_frozen_parameter* parameters = FROZEN_TABLE(h, struct _ini_frozen_parameter, parameters);
+	const uint32_t* order = FROZEN_TABLE(h, uint32_t, parameter_order);
+	const char* strings = FROZEN_TABLE(h, char, strings);
+	uint32_t i, j;
+	
+	/* Create INI file object */
+	ini_file* ini = tini_create_ini();
+	if (!ini || tini_reserve_sections(ini, h->section_count) != 0)
+		goto free_ini;
+	
+	/* Add all parameters in the original order */
+	for (i = 0; i < h->section_count; ++i) {
+		const char* name = strings + sections[i].name;
+		for (j = 0; j < sections[i].parameter_count; ++j) {
+			const struct _ini_frozen_parameter* p = &parameters[order[sections[i].first_parameter + j]];
+			if (tini_add_parameter(ini, name, strings + p->pair + strlen(name) + 1, strings + p->value, 0) != 0)
+				goto free_ini;
+		}
+	}
+	return ini;
+	
+free_ini:
+	/* Free memory on error */
+	{
+		int saved_errno = errno;
+		tini_free_ini(ini);
+		errno = saved_errno;
+	}
+	return NULL;
+}
+
+#ifdef TINI_FEATURE_BINARY_CACHE
+
+static int save_frozen(const ini_frozen* frozen, const char* binary_path, const struct stat* source) {
+	/* Put size and modification time of the source file into the header copy */
+	struct _ini_frozen_header header = *frozen->header;
+	struct iovec iov[2];
+	if (source) {
+		header.source_size = (uint64_t)source->st_size;
+		header.source_mtime = (int64_t)source->st_mtim.tv_sec;
+		header.source_mtime_nsec = (uint32_t)source->st_mtim.tv_nsec;
+	}
+	
+	/* Write header copy followed by the rest of the snapshot */
+	iov[0].iov_base = &header;
+	iov[0].iov_len = sizeof(header);
+	iov[1].iov_base = (void*)(frozen->header + 1);
+	iov[1].iov_len = header.size - sizeof(header);
+	return write_file_atomically(binary_path, iov, 2);
+}
+
+int tini_save_binary(const ini_file* ini, const char* binary_path, const char* source_path) {
+	struct stat source;
+	ini_frozen* frozen;
+	int res, saved_errno;
+	
+	/* Find size and modification time of the source file */
+	if (source_path && stat(source_path, &source) != 0)
+		return -1;
+	
+	/* Create snapshot and save it */
+	frozen = tini_freeze(ini);
+	if (!frozen)
+		return -1;
+	res = save_frozen(frozen, binary_path, source_path ? &source : NULL);
+	saved_errno = errno;
+	tini_free_frozen(frozen);
+	errno = saved_errno;
+	return res;
+}
+
+static int validate_frozen(const struct _ini_frozen_header* h, size_t size) {
+	/* Check signature, byte order, version and size */
+	struct _ini_frozen_header layout;
+	if (size < sizeof(*h) || memcmp(h->magic, FROZEN_MAGIC, sizeof(h->magic)) != 0 
+		|| h->byte_order != FROZEN_BYTE_ORDER || h->version != FROZEN_VERSION || h->size != size || h->reserved != 0)
+		return -1;
+	
+	/* Check that tables are placed exactly where they must be, and string pool ends with null */
+	if (layout_frozen(&layout, h->section_count, h->parameter_count, h->strings_size) != size
+		|| layout.section_bucket_count != h->section_bucket_count || layout.parameter_bucket_count != h->parameter_bucket_count
+		|| layout.sections != h->sections || layout.section_buckets != h->section_buckets 
+		|| layout.section_slots != h->section_slots || layout.parameters != h->parameters 
+		|| layout.parameter_buckets != h->parameter_buckets || layout.parameter_order != h->parameter_order 
+		|| layout.strings != h->strings || (h->strings_size != 0 && ((const char*)h)[size - 1] != '\0'))
+		return -1;
+	
+	return 0;
+}
+
+ini_frozen* tini_load_binary(const char* binary_path, const char* source_path) {
+	ini_frozen* frozen = NULL;
+	struct stat st;
+	void* data;
+	int saved_errno;
+	
+	/* Open binary file and find its size */
+	int fd = open(binary_path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+	if (fstat(fd, &st) != 0)
+		goto close_file;
+	if ((uint64_t)st.st_size < sizeof(struct _ini_frozen_header) || (uint64_t)st.st_size > UINT32_MAX) {
+		errno = EINVAL;
+		goto close_file;
+	}
+	
+	/* Map it into memory read-only and validate header */
+	data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (data == MAP_FAILED)
+		goto close_file;
+	if (validate_frozen(data, (size_t)st.st_size) != 0) {
+		errno = EINVAL;
+		goto unmap_file;
+	}
+	
+	/* Check that source file hasn't changed since binary file was created */
+	if (source_path) {
+		const struct _ini_frozen_header* h = data;
+		struct stat source;
+		if (stat(source_path, &source) != 0)
+			goto unmap_file;
+		if (h->source_size != (uint64_t)source.st_size || h->source_mtime != (int64_t)source.st_mtim.tv_sec 
+			|| h->source_mtime_nsec != (uint32_t)source.st_mtim.tv_nsec) {
+			errno = ESTALE;
+			goto unmap_file;
+		}
+	}
+	
+	/* Create snapshot handle */
+	frozen = allocate(NULL, sizeof(ini_frozen));
+	if (!frozen)
+		goto unmap_file;
+	frozen->header = data;
+	frozen->mapped_size = (size_t)st.st_size;
+	goto close_file;
+	
+unmap_file:
+	/* Unmap file on error */
+	saved_errno = errno;
+	munmap(data, (size_t)st.st_size);
+	errno = saved_errno;
+	
+close_file:
+	/* Close file, preserving errno */
+	saved_errno = errno;
+	close(fd);
+	errno = saved_errno;
+	return frozen;
+}
+
+ini_frozen* tini_load_cached(const char* source_path, const char* binary_path) {
+	struct stat source;
+	ini_frozen* frozen;
+	ini_file* ini;
+	int saved_errno;
+	
+	/* Use binary file if it is valid and up to date */
+	frozen = tini_load_binary(binary_path, source_path);
+	if (frozen)
+		return frozen;
+	
+	/* Otherwise parse source file, remembering its size and modification time before that, 
+	 * so that changes made while parsing make binary file stale.
+	 */
+	if (stat(source_path, &source) != 0)
+		return NULL;
+	ini = tini_load_ini(source_path);
+	if (!ini)
+		return NULL;
+	frozen = tini_freeze(ini);
+	saved_errno = errno;
+	tini_free_ini(ini);
+	errno = saved_errno;
+	
+	/* Rebuild binary file, failure to save it doesn't affect the result */
+	if (frozen) {
+		save_frozen(frozen, binary_path, &source);
+		errno = saved_errno;
+	}
+	return frozen;
+}
+
+#endif
+
+#endif
+
+#ifdef TINI_FEATURE_RELOAD_INI
+
+/* Reader of the reloadable INI file handle. Readers are never removed from the list 
+ * until the handle is destroyed, unregistered readers are reused by later registrations.
+ */
+struct _ini_handle_reader {
+	ini_handle* handle; /* owning handle */
+	ini_file* hazard; /* version being read, or NULL; writers don't free it while it is set */
+	int in_use; /* nonzero while reader is registered */
+	struct _ini_handle_reader* next; /* next reader in the list */
+};
+
+/* Reloadable INI file handle */
+struct _ini_handle {
+	ini_file* current; /* current version, replaced atomically */
+	ini_handle_reader* readers; /* list of readers, prepended atomically */
+	char* file_path; /* INI file path */
+};
+
+ini_handle* tini_create_handle(const char* file_path) {
+	int saved_errno;
+	ini_handle* handle = allocate(NULL, sizeof(ini_handle));
+	if (!handle)
+		return NULL;
+	handle->readers = NULL;
+	handle->file_path = duplicate_string(NULL, file_path);
+	if (!handle->file_path)
+		goto free_handle;
+	handle->current = tini_load_ini(file_path);
+	if (!handle->current)
+		goto free_path;
+	return handle;
+	
+free_path:
+	/* Free resources on error, preserving errno */
+	saved_errno = errno;
+	deallocate(NULL, handle->file_path);
+	errno = saved_errno;
+	
+free_handle:
+	saved_errno = errno;
+	deallocate(NULL, handle);
+	errno = saved_errno;
+	return NULL;
+}
+
+void tini_free_handle(ini_handle* handle) {
+	ini_handle_reader* reader = handle->readers;
+	while (reader) {
+		ini_handle_reader* next = reader->next;
+		deallocate(NULL, reader);
+		reader = next;
+	}
+	tini_free_ini(handle->current);
+	deallocate(NULL, handle->file_path);
+	deallocate(NULL, handle);
+}
+
+static ini_file* replace_ini(ini_handle* handle, ini_file* ini) {
+	/* Replace current version, then wait until no reader holds the old one and return it */
+	ini_file* old = __atomic_exchange_n(&handle->current, ini, __ATOMIC_SEQ_CST);
+	ini_handle_reader* reader = __atomic_load_n(&handle->readers, __ATOMIC_ACQUIRE);
+	for (; reader; reader = reader->next) {
+		while (__atomic_load_n(&reader->hazard, __ATOMIC_SEQ_CST) == old)
+			sched_yield();
+	}
+	return old;
+}
+
+void tini_publish_ini(ini_handle* handle, ini_file* ini) {
+	tini_free_ini(replace_ini(handle, ini));
+}
+
+int tini_reload(ini_handle* handle, const char* file_path) {
+	/* Old version stays current if new one can't be loaded */
+	ini_file* ini = tini_load_ini(file_path ? file_path : handle->file_path);
+	if (!ini)
+		return -1;
+	tini_publish_ini(handle, ini);
+	return 0;
+}
+
+ini_handle_reader* tini_register_reader(ini_handle* handle) {
+	/* Reuse unregistered reader if there is one */
+	ini_handle_reader* reader = __atomic_load_n(&handle->readers, __ATOMIC_ACQUIRE);
+	for (; reader; reader = reader->next) {
+		int expected = 0;
+		if (__atomic_compare_exchange_n(&reader->in_use, &expected, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+			return reader;
+	}
+	
+	/* Otherwise prepend new one to the list */
+	reader = allocate(NULL, sizeof(ini_handle_reader));
+	if (!reader)
+		return NULL;
+	reader->handle = handle;
+	reader->hazard = NULL;
+	reader->in_use = 1;
+	reader->next = __atomic_load_n(&handle->readers, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&handle->readers, &reader->next, reader, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+		;
+	return reader;
+}
+
+void tini_unregister_reader(ini_handle_reader* reader) {
+	__atomic_store_n(&reader->hazard, NULL, __ATOMIC_RELEASE);
+	__atomic_store_n(&reader->in_use, 0, __ATOMIC_RELEASE);
+}
+
+const ini_file* tini_acquire_ini(ini_handle_reader* reader) {
+	/* Announce version being read, and retry if it was replaced meanwhile, 
+	 * because writer might have checked readers before the announcement.
+	 */
+	ini_file* ini = __atomic_load_n(&reader->handle->current, __ATOMIC_ACQUIRE);
+	for (;;) {
+		ini_file* current;
+		__atomic_store_n(&reader->hazard, ini, __ATOMIC_SEQ_CST);
+		current = __atomic_load_n(&reader->handle->current, __ATOMIC_SEQ_CST);
+		if (current == ini)
+			return ini;
+		ini = current;
+	}
+}
+
+void tini_release_ini(ini_handle_reader* reader) {
+	__atomic_store_n(&reader->hazard, NULL, __ATOMIC_RELEASE);
+}
+
+#endif
+
+#ifdef TINI_FEATURE_WATCH_INI
+
+/* Registered change callback */
+struct _ini_change_callback {
+	ini_change_handler handler; /* callback function */
+	void* user; /* user data */
+};
+
+/* INI file watcher */
+struct _ini_watcher {
+	ini_handle* handle; /* watched handle */
+	ini_handle_reader* reader; /* reader holding new version while changes are reported */
+	int fd; /* inotify instance */
+	const char* file_name; /* file name part of the handle file path */
+	unsigned int debounce_ms; /* quiet period required before reload */
+	struct _ini_change_callback* callbacks; /* change callbacks */
+	size_t callback_count; /* number of change callbacks */
+};
+
+/* Events of the watched directory which may mean INI file change. Directory is watched 
+ * instead of the file itself, so that files replaced by rename are tracked as well.
+ */
+#define WATCH_EVENT_MASK (IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO)
+
+ini_watcher* tini_create_watcher(ini_handle* handle, unsigned int debounce_ms) {
+	const char* file_path = handle->file_path;
+	const char* slash = strrchr(file_path, '/');
+	char* directory;
+	int saved_errno;
+	ini_watcher* watcher = allocate(NULL, sizeof(ini_watcher));
+	if (!watcher)
+		return NULL;
+	watcher->handle = handle;
+	watcher->file_name = slash ? slash + 1 : file_path;
+	watcher->debounce_ms = debounce_ms;
+	watcher->callbacks = NULL;
+	watcher->callback_count = 0;
+	watcher->reader = tini_register_reader(handle);
+	if (!watcher->reader)
+		goto free_watcher;
+	
+	/* Find directory of the INI file */
+	if (!slash)
+		directory = duplicate_string(NULL, ".");
+	else if (slash == file_path)
+		directory = duplicate_string(NULL, "/");
+	else {
+		size_t length = (size_t)(slash - file_path);
+		directory = allocate(NULL, length + 1);
+		if (directory) {
+			memcpy(directory, file_path, length);
+			directory[length] = '\0';
+		}
+	}
+	if (!directory)
+		goto unregister_reader;
+	
+	/* Watch directory */
+	watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (watcher->fd < 0)
+		goto free_directory;
+	if (inotify_add_watch(watcher->fd, directory, WATCH_EVENT_MASK) < 0)
+		goto close_fd;
+	deallocate(NULL, directory);
+	return watcher;
+	
+close_fd:
+	/* Free resources on error, preserving errno */
+	saved_errno = errno;
+	close(watcher->fd);
+	errno = saved_errno;
+	
+free_directory:
+	saved_errno = errno;
+	deallocate(NULL, directory);
+	errno = saved_errno;
+	
+unregister_reader:
+	tini_unregister_reader(watcher->reader);
+	
+free_watcher:
+	saved_errno = errno;
+	deallocate(NULL, watcher);
+	errno = saved_errno;
+	return NULL;
+}
+
+void tini_free_watcher(ini_watcher* watcher) {
+	close(watcher->fd);
+	tini_unregister_reader(watcher->reader);
+	deallocate(NULL, watcher->callbacks);
+	deallocate(NULL, watcher);
+}
+
+int tini_add_change_callback(ini_watcher* watcher, ini_change_handler handler, void* user) {
+	struct _ini_change_callback* callbacks = reallocate(NULL, watcher->callbacks, 
+		sizeof(struct _ini_change_callback) * (watcher->callback_count + 1));
+	if (!callbacks)
+		return -1;
+	callbacks[watcher->callback_count].handler = handler;
+	callbacks[watcher->callback_count].user = user;
+	watcher->callbacks = callbacks;
+	++watcher->callback_count;
+	return 0;
+}
+
+int tini_get_watcher_fd(const ini_watcher* watcher) {
+	return watcher->fd;
+}
+
+static int read_watch_events(ini_watcher* watcher) {
+	/* Drain pending events, returns 1 if any of them is about the INI file */
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	int found = 0;
+	for (;;) {
+		const char* p;
+		ssize_t n = read(watcher->fd, buffer, sizeof(buffer));
+		if (n < 0) {
+			if (errno == EAGAIN)
+				return found;
+			if (errno == EINTR)
+				continue;
+			return -1;
+		}
+		for (p = buffer; p < buffer + n; ) {
+			const struct inotify_event* event = (const struct inotify_event*)p;
+			if ((event->mask & WATCH_EVENT_MASK) && event->len && strcmp(event->name, watcher->file_name) == 0)
+				found = 1;
+			p += sizeof(struct inotify_event) + event->len;
+		}
+	}
+}
+
+static long long watch_now_ms(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int wait_watch_events(ini_watcher* watcher, int timeout_ms) {
+	/* Wait for events, returns zero on timeout */
+	struct pollfd pfd;
+	int res;
+	pfd.fd = watcher->fd;
+	pfd.events = POLLIN;
+	do {
+		res = poll(&pfd, 1, timeout_ms);
+	} while (res < 0 && errno == EINTR);
+	return res;
+}
+
+static void notify_changes(ini_watcher* watcher, const ini_file* old_ini, const ini_file* new_ini) {
+	size_t i, j, k;
+	
+	/* Report changed and removed parameters in the old order. Published versions may have 
+	 * tombstones of removed sections and parameters, which are skipped.
+	 */
+	for (i = 0; i < old_ini->section_count; ++i) {
+		const ini_section* old_section = old_ini->sections[i];
+		const ini_section* new_section;
+		if (!old_section)
+			continue;
+		new_section = tini_find_section(new_ini, old_section->name);
+		for (j = 0; j < old_section->parameter_count; ++j) {
+			const char* new_value;
+			if (!old_section->keys[j])
+				continue;
+			new_value = new_section 
+				? tini_find_parameter_in_section(new_section, old_section->keys[j], NULL) : NULL;
+			if (new_value && strcmp(new_value, old_section->values[j]) == 0)
+				continue;
+			for (k = 0; k < watcher->callback_count; ++k)
+				watcher->callbacks[k].handler(watcher->callbacks[k].user, old_section->name, 
+					old_section->keys[j], old_section->values[j], new_value);
+		}
+	}
+	
+	/* Report added parameters in the new order */
+	for (i = 0; i < new_ini->section_count; ++i) {
+		const ini_section* new_section = new_ini->sections[i];
+		const ini_section* old_section;
+		if (!new_section)
+			continue;
+		old_section = tini_find_section(old_ini, new_section->name);
+		for (j = 0; j < new_section->parameter_count; ++j) {
+			if (!new_section->keys[j])
+				continue;
+			if (old_section && tini_find_parameter_in_section(old_section, new_section->keys[j], NULL))
+				continue;
+			for (k = 0; k < watcher->callback_count; ++k)
+				watcher->callbacks[k].handler(watcher->callbacks[k].user, new_section->name, 
+					new_section->keys[j], NULL, new_section->values[j]);
+		}
+	}
+}
+
+int tini_process_watch_events(ini_watcher* watcher, int timeout_ms) {
+	ini_file* ini;
+	ini_file* old_ini;
+	long long deadline;
+	int res;
+	
+	/* Wait for the INI file change. Events about other files of the directory 
+	 * don't end the wait, which goes on for the rest of the timeout.
+	 */
+	deadline = timeout_ms < 0 ? 0 : watch_now_ms() + timeout_ms;
+	for (;;) {
+		int wait_ms = timeout_ms;
+		if (timeout_ms >= 0) {
+			long long remaining = deadline - watch_now_ms();
+			wait_ms = remaining > 0 ? (int)remaining : 0;
+		}
+		res = wait_watch_events(watcher, wait_ms);
+		if (res <= 0)
+			return res;
+		res = read_watch_events(watcher);
+		if (res != 0)
+			break;
+	}
+	if (res < 0)
+		return -1;
+	
+	/* Debounce: wait until the file stays untouched for a while, so that 
+	 * writing it in several steps causes single reload. Events about other 
+	 * files of the directory don't restart the wait, so they can't postpone reload.
+	 */
+	deadline = watch_now_ms() + watcher->debounce_ms;
+	for (;;) {
+		long long remaining = deadline - watch_now_ms();
+		if (remaining <= 0)
+			break;
+		res = wait_watch_events(watcher, (int)remaining);
+		if (res < 0)
+			return -1;
+		if (res == 0)
+			break;
+		res = read_watch_events(watcher);
+		if (res < 0)
+			return -1;
+		if (res > 0)
+			deadline = watch_now_ms() + watcher->debounce_ms;
+	}
+	
+	/* Reload and publish new version, then report differences, so that callbacks see the new 
+	 * version through the handle. New version is held, so that concurrent publishers can't 
+	 * free it meanwhile, and old one is freed after reporting.
+	 */
+	ini = tini_load_ini(watcher->handle->file_path);
+	if (!ini)
+		return -1;
+	__atomic_store_n(&watcher->reader->hazard, ini, __ATOMIC_SEQ_CST);
+	old_ini = replace_ini(watcher->handle, ini);
+	notify_changes(watcher, old_ini, ini);
+	tini_release_ini(watcher->reader);
+	tini_free_ini(old_ini);
+	return 1;
+}
+
+#endif
+
+#ifdef TINI_FEATURE_INCREMENTAL_RELOAD
+
+/* Text span found by incremental reload */
+struct _ini_reload_span {
+	const char* text; /* span text in the file buffer */
+	size_t length; /* length of the span text */
+	uint64_t hash; /* hash of the span text */
+	const char* names; /* names of sections which have parameters in the span, each followed by null */
+	size_t name_count; /* number of section names */
+	size_t names_size; /* total size of section names */
+	char* own_names; /* names allocated by reload, or NULL if they belong to the previous spans */
+	size_t previous; /* index + 1 of the previous span with the same text, or zero */
+};
+
+/* Entry of the list of spans which have parameters of a section */
+struct _ini_span_link {
+	size_t span; /* span index */
+	size_t next; /* index + 1 of the next entry, or zero */
+};
+
+/* Section of the reloaded INI file */
+struct _ini_reload_section {
+	const char* name; /* section name */
+	size_t hash; /* hash of the section name */
+	uint64_t text_hash; /* combined hash of all spans which have parameters of the section */
+	ini_section* section; /* previous section object if it is reused, otherwise new one */
+	int reused; /* nonzero if previous section object is reused */
+	size_t first_link; /* index + 1 of the first and the last entries of the list of spans */
+	size_t last_link; /* which have parameters of the section, or zero */
+};
+
+/* Minimum size increment of the storage for text spans, files usually split into many spans */
+#define RELOAD_SPAN_STORAGE_SIZE_INCREMENT 64
+
+/* Incremental reload state */
+struct _ini_reload {
+	ini_file* ini; /* INI file object being reloaded */
+	struct _ini_reload_span* spans; /* text spans of the file */
+	size_t span_count; /* number of text spans */
+	struct _ini_reload_section* sections; /* sections in the file order */
+	size_t section_count; /* number of sections */
+	size_t* section_index; /* open addressing hash table of section indexes + 1 */
+	size_t section_index_size; /* number of slots in the section hash table, power of two */
+	struct _ini_span_link* links; /* lists of spans which have parameters of sections */
+	size_t link_count; /* number of used list entries */
+	struct _ini_span_link* previous_links; /* same lists for previous sections and spans */
+	size_t* previous_first_links; /* index + 1 of the first and the last list entries of */
+	size_t* previous_last_links; /* each previous section, or zero */
+	char* names; /* section names being collected while parsing span */
+	size_t name_count; /* number of collected names */
+	size_t names_size; /* total size of collected names */
+	char* text; /* scratch buffer for parsing spans in place */
+	int error; /* errno of the first failure while parsing, or zero */
+};
+
+static uint64_t hash_text(const char* text, size_t length) {
+	/* FNV-1a style hash of the given bytes taken 8 at a time, so that hashing 
+	 * the whole file on every reload costs little compared to parsing it.
+	 */
+	uint64_t h = HASH_BASIS ^ length;
+	const char* end = text + length;
+	for (; end - text >= 8; text += 8) {
+		uint64_t word;
+		memcpy(&word, text, 8);
+		h = (h ^ word) * 1099511628211ULL;
+		h ^= h >> 29;
+	}
+	for (; text < end; ++text)
+		h = (h ^ (unsigned char)*text) * 1099511628211ULL;
+	return h ^ (h >> 32);
+}
+
+static int add_text_span(struct _ini_reload* reload, const char* start, const char* end, size_t* max_span_count) {
+	struct _ini_reload_span* span;
+	if (reload->span_count == *max_span_count) {
+		size_t new_max_span_count = grow_storage_size(*max_span_count, *max_span_count + 1, 
+			RELOAD_SPAN_STORAGE_SIZE_INCREMENT);
+		span = reallocate(NULL, reload->spans, sizeof(struct _ini_reload_span) * new_max_span_count);
+		if (!span)
+			return -1;
+		reload->spans = span;
+		*max_span_count = new_max_span_count;
+	}
+	span = reload->spans + reload->span_count++;
+	span->text = start;
+	span->length = end - start;
+	span->hash = hash_text(start, span->length);
+	span->names = NULL;
+	span->name_count = 0;
+	span->names_size = 0;
+	span->own_names = NULL;
+	span->previous = 0;
+	return 0;
+}
+
+static int split_text_spans(struct _ini_reload* reload, const char* text, size_t length) {
+	/* Split text at valid section headers in the beginning of line. Parser state is reset 
+	 * by such header, so each span is parsed the same way regardless of the preceding text.
+	 * Only '[' characters are searched for, which are rare outside of section headers.
+	 */
+	const char* end = text + length;
+	const char* start = text;
+	const char* p = text;
+	size_t max_span_count = 0;
+	while (p < end && (p = memchr(p, '[', end - p)) != NULL) {
+		if (p > text && p[-1] == '\n' && is_section_header_line(p, end)) {
+			if (add_text_span(reload, start, p, &max_span_count) != 0)
+				return -1;
+			start = p;
+		}
+		++p;
+	}
+	return start < end ? add_text_span(reload, start, end, &max_span_count) : 0;
+}
+
+static int reload_handler_failed(struct _ini_reload* reload) {
+	/* Remember failure, stop calling handlers */
+	if (!reload->error)
+		reload->error = errno ? errno : ENOMEM;
+	return 0;
+}
+
+static int collect_names_handler(void* user, const char* section, const char* name, const char* value) {
+	/* Collect distinct names of sections which have parameters in the span */
+	struct _ini_reload* reload = user;
+	size_t i, size = strlen(section) + 1;
+	const char* p = reload->names;
+	char* names;
+	(void)name;
+	(void)value;
+	if (reload->error)
+		return 0;
+	for (i = 0; i < reload->name_count; ++i, p += strlen(p) + 1) {
+		if (strcmp(p, section) == 0)
+			return 1;
+	}
+	names = reallocate(NULL, reload->names, reload->names_size + size);
+	if (!names)
+		return reload_handler_failed(reload);
+	memcpy(names + reload->names_size, section, size);
+	reload->names = names;
+	reload->names_size += size;
+	++reload->name_count;
+	return 1;
+}
+
+static void parse_text_span(struct _ini_reload* reload, const struct _ini_reload_span* span, ini_handler handler) {
+	/* Parse copy of the span text, so that the file buffer is kept intact */
+	memcpy(reload->text, span->text, span->length);
+	ini_parse_buffer(reload->text, span->length, handler, reload);
+}
+
+static size_t find_text_span(const ini_file* ini, const size_t* index, size_t index_size, 
+	const struct _ini_reload_span* span) 
+{
+	/* Find previous span with the same text, returns its index + 1 or zero. 
+	 * Text is compared, so that hash collision can't make changed span look unchanged.
+	 */
+	size_t i, j;
+	for (i = (size_t)span->hash & (index_size - 1); (j = index[i]) != 0; i = (i + 1) & (index_size - 1)) {
+		const struct _ini_text_span* previous = ini->spans + j - 1;
+		if (previous->hash == span->hash && previous->length == span->length 
+			&& memcmp(previous->text, span->text, span->length) == 0)
+			return j;
+	}
+	return 0;
+}
+
+static int find_span_names(struct _ini_reload* reload) {
+	/* Hash table of previous spans, load factor is kept at most 1/2 */
+	ini_file* ini = reload->ini;
+	size_t i, j, index_size = TINI_SECTION_INDEX_INITIAL_SIZE;
+	size_t* index;
+	while (index_size < ini->span_count * 2)
+		index_size *= 2;
+	index = allocate_zeroed(NULL, sizeof(size_t) * index_size);
+	if (!index)
+		return -1;
+	for (i = 0; i < ini->span_count; ++i) {
+		for (j = (size_t)ini->spans[i].hash & (index_size - 1); index[j] != 0; j = (j + 1) & (index_size - 1))
+			;
+		index[j] = i + 1;
+	}
+	
+	/* Take section names of unchanged spans from the previous spans, parse changed spans to find them */
+	for (i = 0; i < reload->span_count; ++i) {
+		struct _ini_reload_span* span = reload->spans + i;
+		span->previous = find_text_span(ini, index, index_size, span);
+		if (span->previous) {
+			const struct _ini_text_span* previous = ini->spans + span->previous - 1;
+			span->names = previous->names;
+			span->name_count = previous->name_count;
+			for (j = 0; j < span->name_count; ++j)
+				span->names_size += strlen(span->names + span->names_size) + 1;
+		} else {
+			reload->name_count = 0;
+			reload->names_size = 0;
+			parse_text_span(reload, span, &collect_names_handler);
+			span->names = span->own_names = reload->names;
+			span->name_count = reload->name_count;
+			span->names_size = reload->names_size;
+			reload->names = NULL;
+			if (reload->error) {
+				deallocate(NULL, index);
+				errno = reload->error;
+				return -1;
+			}
+		}
+	}
+	
+	deallocate(NULL, index);
+	return 0;
+}
+
+static struct _ini_reload_section* find_reload_section(const struct _ini_reload* reload, const char* name, size_t hash) {
+	size_t i, j, mask = reload->section_index_size - 1;
+	for (i = hash & mask; (j = reload->section_index[i]) != 0; i = (i + 1) & mask) {
+		struct _ini_reload_section* section = reload->sections + j - 1;
+		if (section->hash == hash && strcmp(section->name, name) == 0)
+			return section;
+	}
+	return NULL;
+}
+
+static void link_span(struct _ini_span_link* links, size_t* link_count, size_t* first_link, size_t* last_link, size_t span) {
+	/* Append span to the list */
+	struct _ini_span_link* link = links + (*link_count)++;
+	link->span = span;
+	link->next = 0;
+	if (*last_link)
+		links[*last_link - 1].next = *link_count;
+	else
+		*first_link = *link_count;
+	*last_link = *link_count;
+}
+
+static int find_reload_sections(struct _ini_reload* reload) {
+	/* Upper bound of the number of sections is the total number of names in spans */
+	size_t i, j, max_section_count = 0;
+	for (i = 0; i < reload->span_count; ++i)
+		max_section_count += reload->spans[i].name_count;
+	reload->sections = allocate(NULL, sizeof(struct _ini_reload_section) * (max_section_count + 1));
+	reload->links = allocate(NULL, sizeof(struct _ini_span_link) * (max_section_count + 1));
+	reload->section_index_size = TINI_SECTION_INDEX_INITIAL_SIZE;
+	while (reload->section_index_size < max_section_count * 2)
+		reload->section_index_size *= 2;
+	reload->section_index = allocate_zeroed(NULL, sizeof(size_t) * reload->section_index_size);
+	if (!reload->sections || !reload->links || !reload->section_index)
+		return -1;
+	
+	/* Find sections in the order of the first parameter, as full parse does, 
+	 * combine hashes of spans which have their parameters and list these spans.
+	 */
+	for (i = 0; i < reload->span_count; ++i) {
+		const struct _ini_reload_span* span = reload->spans + i;
+		const char* name = span->names;
+		for (j = 0; j < span->name_count; ++j, name += strlen(name) + 1) {
+			size_t hash = hash_string(name);
+			struct _ini_reload_section* section = find_reload_section(reload, name, hash);
+			if (!section) {
+				size_t k, mask = reload->section_index_size - 1;
+				section = reload->sections + reload->section_count;
+				section->name = name;
+				section->hash = hash;
+				section->text_hash = HASH_BASIS;
+				section->section = NULL;
+				section->reused = 0;
+				section->first_link = 0;
+				section->last_link = 0;
+				for (k = hash & mask; reload->section_index[k] != 0; k = (k + 1) & mask)
+					;
+				reload->section_index[k] = ++reload->section_count;
+			}
+			section->text_hash = (section->text_hash ^ span->hash) * 1099511628211ULL;
+			link_span(reload->links, &reload->link_count, &section->first_link, &section->last_link, i);
+		}
+	}
+	return 0;
+}
+
+static int link_previous_spans(struct _ini_reload* reload) {
+	/* List previous spans which have parameters of each previous section */
+	const ini_file* ini = reload->ini;
+	size_t i, j, k, link_count = 0, max_link_count = 0;
+	for (i = 0; i < ini->span_count; ++i)
+		max_link_count += ini->spans[i].name_count;
+	reload->previous_links = allocate(NULL, sizeof(struct _ini_span_link) * (max_link_count + 1));
+	reload->previous_first_links = allocate_zeroed(NULL, sizeof(size_t) * (ini->section_count + 1));
+	reload->previous_last_links = allocate_zeroed(NULL, sizeof(size_t) * (ini->section_count + 1));
+	if (!reload->previous_links || !reload->previous_first_links || !reload->previous_last_links)
+		return -1;
+	for (i = 0; i < ini->span_count; ++i) {
+		const char* name = ini->spans[i].names;
+		for (j = 0; j < ini->spans[i].name_count; ++j, name += strlen(name) + 1) {
+			k = find_section_index(ini, name);
+			if (k != 0)
+				link_span(reload->previous_links, &link_count, reload->previous_first_links + k - 1, 
+					reload->previous_last_links + k - 1, i);
+		}
+	}
+	return 0;
+}
+
+static int is_section_text_unchanged(const struct _ini_reload* reload, const struct _ini_reload_section* section, size_t k) {
+	/* Section is parsed from the same text if both lists have spans with the same text in the same order. 
+	 * Spans matched to previous ones by find_text_span are already compared, others are compared here.
+	 */
+	const ini_file* ini = reload->ini;
+	size_t i = section->first_link, j = reload->previous_first_links[k];
+	for (; i != 0 && j != 0; i = reload->links[i - 1].next, j = reload->previous_links[j - 1].next) {
+		const struct _ini_reload_span* span = reload->spans + reload->links[i - 1].span;
+		const struct _ini_text_span* previous = ini->spans + reload->previous_links[j - 1].span;
+		if (span->previous == reload->previous_links[j - 1].span + 1)
+			continue;
+		if (span->length != previous->length || memcmp(span->text, previous->text, span->length) != 0)
+			return 0;
+	}
+	return i == 0 && j == 0;
+}
+
+static int fill_sections_handler(void* user, const char* section, const char* name, const char* value) {
+	/* Add parameters of new sections only, reused sections are complete */
+	struct _ini_reload* reload = user;
+	struct _ini_reload_section* s;
+	if (reload->error)
+		return 0;
+	s = find_reload_section(reload, section, hash_string(section));
+	if (!s || s->reused)
+		return 1;
+	if (!name) {
+		/* Continuation line of multi-line value */
+		if (append_parameter_value(reload->ini, value) != 0)
+			return reload_handler_failed(reload);
+		return 1;
+	}
+	reload->ini->last_section = NULL;
+	if (tini_add_parameter_to_section(s->section, name, value, 1) != 0)
+		return reload_handler_failed(reload);
+	return 1;
+}
+
+static int build_reload_sections(struct _ini_reload* reload) {
+	ini_file* ini = reload->ini;
+	size_t i, j;
+	
+	/* Reuse previous section objects parsed from the same text, create others. 
+	 * Hashes of span texts are compared first, then texts themselves.
+	 */
+	if (link_previous_spans(reload) != 0)
+		return -1;
+	for (i = 0; i < reload->section_count; ++i) {
+		struct _ini_reload_section* section = reload->sections + i;
+		size_t k = find_section_index(ini, section->name);
+		if (k != 0 && ini->sections[k - 1]->text_hash == section->text_hash 
+			&& is_section_text_unchanged(reload, section, k - 1)) {
+			section->section = ini->sections[k - 1];
+			section->reused = 1;
+		} else {
+			section->section = new_section(ini, section->name);
+			if (!section->section)
+				return -1;
+		}
+	}
+	
+	/* Parse spans which have parameters of new sections */
+	for (i = 0; i < reload->span_count; ++i) {
+		const struct _ini_reload_span* span = reload->spans + i;
+		const char* name = span->names;
+		for (j = 0; j < span->name_count; ++j, name += strlen(name) + 1) {
+			if (!find_reload_section(reload, name, hash_string(name))->reused)
+				break;
+		}
+		if (j < span->name_count) {
+			parse_text_span(reload, span, &fill_sections_handler);
+			if (reload->error) {
+				errno = reload->error;
+				return -1;
+			}
+		}
+	}
+	
+	/* Remember which spans new sections were parsed from */
+	for (i = 0; i < reload->section_count; ++i)
+		reload->sections[i].section->text_hash = reload->sections[i].text_hash;
+	return 0;
+}
+
+static struct _ini_text_span* copy_text_spans(const struct _ini_reload* reload) {
+	/* Copy texts, hashes and section names of spans for the next reload */
+	size_t i;
+	struct _ini_text_span* spans = allocate(reload->ini, sizeof(struct _ini_text_span) * (reload->span_count + 1));
+	if (!spans)
+		return NULL;
+	for (i = 0; i < reload->span_count; ++i) {
+		const struct _ini_reload_span* span = reload->spans + i;
+		spans[i].text = span->text;
+		spans[i].length = span->length;
+		spans[i].hash = span->hash;
+		spans[i].name_count = span->name_count;
+		spans[i].names = allocate(reload->ini, span->names_size + 1);
+		if (!spans[i].names) {
+			free_text_spans(reload->ini, spans, i);
+			return NULL;
+		}
+		if (span->names_size)
+			memcpy(spans[i].names, span->names, span->names_size);
+	}
+	return spans;
+}
+
+static void commit_reload(struct _ini_reload* reload, struct _ini_text_span* spans, char* text) {
+	ini_file* ini = reload->ini;
+	size_t i;
+	
+	/* Destroy previous sections which aren't reused */
+	for (i = 0; i < ini->section_count; ++i) {
+		const char* name = ini->sections[i]->name;
+		const struct _ini_reload_section* section = find_reload_section(reload, name, hash_string(name));
+		if (!section || section->section != ini->sections[i])
+			free_section(ini->sections[i]);
+	}
+	
+	/* Put sections in the file order, storage and hash table are already large enough */
+	for (i = 0; i < reload->section_count; ++i)
+		ini->sections[i] = reload->sections[i].section;
+	ini->section_count = reload->section_count;
+	rebuild_section_index(ini, ini->section_index_size);
+	
+	/* Sections may have been destroyed, invalidate parameter handles */
+	ini->generation = next_generation();
+	
+	/* Replace spans and text they point into */
+	free_text_spans(ini, ini->spans, ini->span_count);
+	deallocate(NULL, ini->span_text);
+	ini->spans = spans;
+	ini->span_count = reload->span_count;
+	ini->span_text = text;
+}
+
+int tini_reload_ini(ini_file* ini, const char* file_path) {
+	struct _ini_reload reload;
+	struct _ini_text_span* spans = NULL;
+	size_t i, length, max_length = 0;
+	int saved_errno, res = -1;
+	char* text;
+	
+	/* Strings of objects parsed in place point into their text buffer */
+	if (ini->buffer) {
+		errno = EINVAL;
+		return -1;
+	}
+	
+	/* Sections and parameters are matched by their indexes, drop tombstones of removed ones */
+	COMPACT_INI(ini);
+	
+	/* Read and split file text */
+	text = read_text_file(NULL, file_path, &length);
+	if (!text)
+		return -1;
+	memset(&reload, 0, sizeof(reload));
+	reload.ini = ini;
+	if (split_text_spans(&reload, text, length) != 0)
+		goto cleanup;
+	for (i = 0; i < reload.span_count; ++i) {
+		if (reload.spans[i].length > max_length)
+			max_length = reload.spans[i].length;
+	}
+	reload.text = allocate(NULL, max_length + 1);
+	if (!reload.text)
+		goto cleanup;
+	
+	/* Parse changed spans and sections which have parameters in them. 
+	 * INI file object is modified only once everything is ready.
+	 */
+	if (find_span_names(&reload) == 0 && find_reload_sections(&reload) == 0 
+		&& build_reload_sections(&reload) == 0 && (spans = copy_text_spans(&reload)) != NULL
+		&& tini_reserve_sections(ini, reload.section_count) == 0) {
+		commit_reload(&reload, spans, text);
+		text = NULL;
+		res = 0;
+	}
+	
+cleanup:
+	/* Free reload state, destroying new sections on error. Parameter added last belongs to 
+	 * a section which was replaced or destroyed, so continuation lines can't be appended to it.
+	 */
+	saved_errno = errno;
+	ini->last_section = NULL;
+	if (res != 0) {
+		if (spans)
+			free_text_spans(ini, spans, reload.span_count);
+		for (i = 0; i < reload.section_count; ++i) {
+			if (reload.sections[i].section && !reload.sections[i].reused)
+				free_section(reload.sections[i].section);
+		}
+	}
+	for (i = 0; i < reload.span_count; ++i)
+		deallocate(NULL, reload.spans[i].own_names);
+	deallocate(NULL, reload.spans);
+	deallocate(NULL, reload.sections);
+	deallocate(NULL, reload.section_index);
+	deallocate(NULL, reload.links);
+	deallocate(NULL, reload.previous_links);
+	deallocate(NULL, reload.previous_first_links);
+	deallocate(NULL, reload.previous_last_links);
+	deallocate(NULL, reload.names);
+	deallocate(NULL, reload.text);
+	deallocate(NULL, text);
+	errno = saved_errno;
+	return res;
+}
+
+#endif
+
+#ifdef TINI_FEATURE_PARALLEL_LOAD
+
+/* Chunk of INI file text parsed by a worker thread */
+struct _ini_parallel_chunk {
+	const char* text; /* chunk text */
+	size_t length; /* length of the chunk text */
+	ini_file* ini; /* partial INI file object, or NULL if parsing failed */
+};
+
+/* Parallel load state shared by worker threads */
+struct _ini_parallel_load {
+	struct _ini_parallel_chunk* chunks; /* chunks in the file order */
+	size_t chunk_count; /* number of chunks */
+	size_t next_chunk; /* index of the next chunk to parse, taken atomically */
+};
+
+static void* parallel_load_worker(void* arg) {
+	/* Take chunks one by one and parse each of them into partial INI file object */
+	struct _ini_parallel_load* load = arg;
+	size_t i;
+	while ((i = __atomic_fetch_add(&load->next_chunk, 1, __ATOMIC_RELAXED)) < load->chunk_count) {
+		/* Chunk is copied into the arena of partial object and parsed there in place, 
+		 * so that workers never write into the memory which other workers read.
+		 */
+		struct _ini_parallel_chunk* chunk = load->chunks + i;
+		char* text;
+		chunk->ini = tini_create_ini_ex(TINI_FLAG_USE_ARENA);
+		if (!chunk->ini)
+			continue;
+		text = arena_alloc(chunk->ini, chunk->length + 1, 1);
+		if (!text) {
+			tini_free_ini(chunk->ini);
+			chunk->ini = NULL;
+			continue;
+		}
+		memcpy(text, chunk->text, chunk->length);
+		parse_in_place(chunk->ini, text, chunk->length);
+	}
+	return NULL;
+}
+
+static void run_workers(void* (*worker)(void*), void* arg, unsigned int thread_count) {
+	/* Run worker on given number of threads, calling thread works too. 
+	 * If some threads can't be started, remaining ones do more work.
+	 */
+	pthread_t* threads = allocate(NULL, sizeof(pthread_t) * thread_count);
+	unsigned int i, started = 0;
+	for (i = 1; threads && i < thread_count; ++i) {
+		if (pthread_create(threads + started, NULL, worker, arg) != 0)
+			break;
+		++started;
+	}
+	worker(arg);
+	for (i = 0; i < started; ++i)
+		pthread_join(threads[i], NULL);
+	deallocate(NULL, threads);
+}
+
+static unsigned int default_thread_count(unsigned int thread_count) {
+	/* Zero means one thread per CPU */
+	long online;
+	if (thread_count != 0)
+		return thread_count;
+	online = sysconf(_SC_NPROCESSORS_ONLN);
+	return online > 0 ? (unsigned int)online : 1;
+}
+
+static size_t split_parallel_chunks(struct _ini_parallel_load* load, const char* text, size_t length, size_t max_chunk_count) {
+	/* Split text into chunks of roughly equal size at valid section headers in the beginning of line, 
+	 * which reset parser state, so that chunks are parsed the same way as the whole text.
+	 */
+	const char* end = text + length;
+	const char* start = text;
+	size_t i;
+	for (i = 1; i < max_chunk_count; ++i) {
+		const char* p = text + length / max_chunk_count * i;
+		if (p <= start)
+			p = start + 1;
+		while (p < end && (p = memchr(p, '[', end - p)) != NULL && !(p[-1] == '\n' && is_section_header_line(p, end)))
+			++p;
+		if (!p || p >= end)
+			break;
+		load->chunks[load->chunk_count].text = start;
+		load->chunks[load->chunk_count].length = p - start;
+		load->chunks[load->chunk_count].ini = NULL;
+		++load->chunk_count;
+		start = p;
+	}
+	load->chunks[load->chunk_count].text = start;
+	load->chunks[load->chunk_count].length = end - start;
+	load->chunks[load->chunk_count].ini = NULL;
+	return ++load->chunk_count;
+}
+
+static void move_arena(ini_file* to, ini_file* from) {
+	/* Link chunks after the current chunk of the target arena, which stays current */
+	struct _ini_arena_chunk* last = from->arena;
+	if (!last)
+		return;
+	while (last->next)
+		last = last->next;
+	if (to->arena) {
+		last->next = to->arena->next;
+		to->arena->next = from->arena;
+	} else
+		to->arena = from->arena;
+	from->arena = NULL;
+}
+
+static int merge_partial_ini(ini_file* ini, ini_file* partial) {
+	size_t i, j;
+	int res = 0;
+	
+	/* Strings of partial objects live in their arenas, which are moved */
+	ini->borrow_strings = 1;
+	for (i = 0; i < partial->section_count; ++i) {
+		ini_section* section = partial->sections[i];
+		size_t k = find_section_index(ini, section->name);
+		if (k != 0) {
+			/* Section seen before: add parameters, later duplicates replace earlier ones */
+			ini_section* target = ini->sections[k - 1];
+			for (j = 0; j < section->parameter_count && res == 0; ++j)
+				res = tini_add_parameter_to_section(target, section->keys[j], section->values[j], 1);
+			cleanup_section(section);
+		} else if (res == 0 && reserve_section_storage(ini, ini->section_count + 1) == 0 
+			&& reserve_section_index(ini, ini->section_count + 1) == 0) {
+			/* New section: move it, keeping the first-seen order */
+			section->owner = ini;
+			ini->sections[ini->section_count] = section;
+			insert_section_index(ini, ini->section_count++);
+		} else {
+			res = -1;
+			cleanup_section(section);
+		}
+	}
+	ini->borrow_strings = 0;
+	
+	/* Sections are moved or cleaned up, partial object keeps nothing but its storage */
+	partial->section_count = 0;
+	move_arena(ini, partial);
+	return res;
+}
+
+ini_file* tini_load_ini_parallel(const char* file_path, unsigned int thread_count) {
+	struct _ini_parallel_load load;
+	size_t i, length, max_chunk_count;
+	int saved_errno, res = 0;
+	ini_file* ini;
+	char* text;
+	
+	/* Read file with room for terminating null */
+	text = read_text_file(NULL, file_path, &length);
+	if (!text)
+		return NULL;
+	
+	/* Small files and single thread don't need splitting */
+	thread_count = default_thread_count(thread_count);
+	max_chunk_count = length / TINI_PARALLEL_LOAD_MIN_CHUNK_SIZE;
+	if (max_chunk_count > (size_t)thread_count * 4)
+		max_chunk_count = (size_t)thread_count * 4;
+	if (thread_count == 1 || max_chunk_count < 2)
+		return tini_load_ini_from_buffer_in_place(text, length);
+	
+	/* Result object takes over arenas of partial objects, where strings of all chunks are */
+	ini = tini_create_ini_ex(TINI_FLAG_USE_ARENA);
+	if (!ini)
+		goto free_text;
+	
+	/* Split text into chunks */
+	load.chunks = allocate(NULL, sizeof(struct _ini_parallel_chunk) * max_chunk_count);
+	load.chunk_count = 0;
+	load.next_chunk = 0;
+	if (!load.chunks)
+		goto free_ini;
+	split_parallel_chunks(&load, text, length, max_chunk_count);
+	
+	/* Parse chunks by worker threads */
+	if (thread_count > load.chunk_count)
+		thread_count = (unsigned int)load.chunk_count;
+	run_workers(&parallel_load_worker, &load, thread_count);
+	
+	/* Merge partial objects in the file order */
+	for (i = 0; i < load.chunk_count; ++i) {
+		ini_file* partial = load.chunks[i].ini;
+		if (!partial || (res == 0 && merge_partial_ini(ini, partial) != 0))
+			res = -1;
+		saved_errno = errno;
+		tini_free_ini(partial);
+		errno = saved_errno;
+	}
+	deallocate(NULL, load.chunks);
+	if (res == 0) {
+		deallocate(NULL, text);
+		return ini;
+	}
+	
+free_ini:
+	/* Free memory on error */
+	saved_errno = errno;
+	tini_free_ini(ini);
+	errno = saved_errno;
+	
+free_text:
+	saved_errno = errno;
+	deallocate(NULL, text);
+	errno = saved_errno;
+	return NULL;
+}
+
+#endif
+
+#ifdef TINI_FEATURE_LOAD_DIR
+
+/* Minimum size increment of the storage for files found by directory loader */
+#define DIR_FILE_STORAGE_SIZE_INCREMENT 16
+
+/* File loaded by directory loader */
+struct _ini_dir_file {
+	char* path; /* file path */
+	ini_file* ini; /* partial INI file object, or NULL if loading failed */
+	int error; /* errno if loading failed */
+	int line; /* number of the first line with parse error, or zero */
+};
+
+/* Directory load state shared by worker threads */
+struct _ini_dir_load {
+	struct _ini_dir_file* files; /* files in the lexical order */
+	size_t file_count; /* number of files */
+	size_t next_file; /* index of the next file to load, taken atomically */
+};
+
+static void* dir_load_worker(void* arg) {
+	/* Take files one by one and parse each of them into partial INI file object */
+	struct _ini_dir_load* load = arg;
+	size_t i;
+	while ((i = __atomic_fetch_add(&load->next_file, 1, __ATOMIC_RELAXED)) < load->file_count) {
+		/* Read file right into the arena of partial object, where it is parsed in place */
+		struct _ini_dir_file* file = load->files + i;
+		size_t length;
+		char* text;
+		file->ini = tini_create_ini_ex(TINI_FLAG_USE_ARENA);
+		text = file->ini ? read_text_file(file->ini, file->path, &length) : NULL;
+		if (text)
+			file->line = parse_in_place(file->ini, text, length);
+		else {
+			file->error = errno;
+			tini_free_ini(file->ini);
+			file->ini = NULL;
+		}
+	}
+	return NULL;
+}
+
+static int compare_dir_files(const void* a, const void* b) {
+	return strcmp(((const struct _ini_dir_file*)a)->path, ((const struct _ini_dir_file*)b)->path);
+}
+
+static int list_dir_files(struct _ini_dir_load* load, const char* dir_path, const char* pattern) {
+	/* Collect regular files matching the pattern, hidden files are matched only explicitly */
+	size_t dir_length = strlen(dir_path), max_file_count = 0;
+	struct dirent* entry;
+	DIR* dir = opendir(dir_path);
+	if (!dir)
+		return -1;
+	while ((entry = readdir(dir)) != NULL) {
+		struct stat st;
+		size_t name_length = strlen(entry->d_name);
+		char* path;
+		if (fnmatch(pattern ? pattern : "*", entry->d_name, FNM_PERIOD) != 0)
+			continue;
+		path = allocate(NULL, dir_length + name_length + 2);
+		if (!path)
+			goto close_dir;
+		memcpy(path, dir_path, dir_length);
+		path[dir_length] = '/';
+		memcpy(path + dir_length + 1, entry->d_name, name_length + 1);
+		if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+			deallocate(NULL, path);
+			continue;
+		}
+		if (load->file_count == max_file_count) {
+			size_t new_max_file_count = grow_storage_size(max_file_count, max_file_count + 1, 
+				DIR_FILE_STORAGE_SIZE_INCREMENT);
+			struct _ini_dir_file* files = reallocate(NULL, load->files, sizeof(struct _ini_dir_file) * new_max_file_count);
+			if (!files) {
+				deallocate(NULL, path);
+				goto close_dir;
+			}
+			load->files = files;
+			max_file_count = new_max_file_count;
+		}
+		load->files[load->file_count].path = path;
+		load->files[load->file_count].ini = NULL;
+		load->files[load->file_count].error = 0;
+		load->files[load->file_count].line = 0;
+		++load->file_count;
+	}
+	closedir(dir);
+	
+	/* Files are merged in the lexical order of their names, which all share the same prefix */
+	if (load->file_count > 1)
+		qsort(load->files, load->file_count, sizeof(struct _ini_dir_file), &compare_dir_files);
+	return 0;
+	
+close_dir:
+	{
+		int saved_errno = errno;
+		closedir(dir);
+		errno = saved_errno;
+	}
+	return -1;
+}
+
+static int make_file_statuses(const struct _ini_dir_load* load, size_t dir_length, 
+			      ini_file_status** statuses, size_t* status_count) {
+	/* Report result of loading each file by its name */
+	size_t i;
+	*statuses = allocate(NULL, sizeof(ini_file_status) * (load->file_count + 1));
+	if (!*statuses)
+		return -1;
+	for (i = 0; i < load->file_count; ++i) {
+		(*statuses)[i].file_name = duplicate_string(NULL, load->files[i].path + dir_length + 1);
+		if (!(*statuses)[i].file_name) {
+			tini_free_file_statuses(*statuses, i);
+			*statuses = NULL;
+			return -1;
+		}
+		(*statuses)[i].error = load->files[i].error;
+		(*statuses)[i].line = load->files[i].line;
+	}
+	*status_count = load->file_count;
+	return 0;
+}
+
+ini_file* tini_load_dir(const char* dir_path, const char* pattern, unsigned int thread_count, 
+			ini_file_status** statuses, size_t* status_count) {
+	struct _ini_dir_load load;
+	size_t i;
+	int saved_errno, res = 0;
+	ini_file* ini;
+	
+	/* Result object takes over arenas of partial objects, where strings of all files are */
+	ini = tini_create_ini_ex(TINI_FLAG_USE_ARENA);
+	if (!ini)
+		return NULL;
+	
+	/* Find files */
+	load.files = NULL;
+	load.file_count = 0;
+	load.next_file = 0;
+	if (list_dir_files(&load, dir_path, pattern) != 0)
+		res = -1;
+	
+	/* Load files by bounded number of worker threads */
+	if (res == 0 && load.file_count > 0) {
+		thread_count = default_thread_count(thread_count);
+		if (thread_count > load.file_count)
+			thread_count = (unsigned int)load.file_count;
+		run_workers(&dir_load_worker, &load, thread_count);
+	}
+	
+	/* Merge loaded files in the lexical order, files which failed to load are skipped */
+	for (i = 0; i < load.file_count; ++i) {
+		ini_file* partial = load.files[i].ini;
+		if (partial && res == 0 && merge_partial_ini(ini, partial) != 0)
+			res = -1;
+		saved_errno = errno;
+		tini_free_ini(partial);
+		errno = saved_errno;
+	}
+	if (res == 0 && statuses && make_file_statuses(&load, strlen(dir_path), statuses, status_count) != 0)
+		res = -1;
+	
+	/* Free file list, and result object on failure */
+	saved_errno = errno;
+	for (i = 0; i < load.file_count; ++i)
+		deallocate(NULL, load.files[i].path);
+	deallocate(NULL, load.files);
+	if (res != 0) {
+		tini_free_ini(ini);
+		ini = NULL;
+	}
+	errno = saved_errno;
+	return ini;
+}
+
+void tini_free_file_statuses(ini_file_status* statuses, size_t count) {
+	size_t i;
+	if (statuses) {
+		for (i = 0; i < count; ++i)
+			deallocate(NULL, statuses[i].file_name);
+		deallocate(NULL, statuses);
+	}
+}
+
+#endif